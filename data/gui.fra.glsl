@@ -3,15 +3,15 @@
 precision mediump float;
 
 uniform sampler2D uTexture;
-uniform vec4 uColor;
-uniform float uIsTex;
 
 varying vec2 vTex;
+varying vec4 vColor;
+varying float vIsTex;
 
 void main() {
-	if (uIsTex > 0.5) {
-		gl_FragColor = texture2D(uTexture, vTex) * uColor;
+	if (vIsTex > 0.5) {
+		gl_FragColor = texture2D(uTexture, vTex) * vColor;
 	} else {
-		gl_FragColor = uColor;
+		gl_FragColor = vColor;
 	}
 }
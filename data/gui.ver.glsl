@@ -3,16 +3,19 @@
 precision mediump float;
 
 uniform mat4 uProj;
-uniform mat4 uModel;
-uniform mat4 uPos;
-uniform mat4 uTex;
 
 attribute vec2 aPos;
+attribute vec2 aTex;
+attribute vec4 aColor;
+attribute float aIsTex;
 
 varying vec2 vTex;
+varying vec4 vColor;
+varying float vIsTex;
 
 void main() {
-	gl_Position = uProj * uModel * uPos * vec4(aPos, 0, 1);
-	vec4 tex = uTex * vec4(aPos, 0, 1);
-	vTex = tex.xy;
+	gl_Position = uProj * vec4(aPos, 0, 1);
+	vTex = aTex;
+	vColor = aColor;
+	vIsTex = aIsTex;
 }
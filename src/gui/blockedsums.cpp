@@ -0,0 +1,140 @@
+#include "blockedsums.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace gui {
+
+	namespace {
+
+		// Blocks are split when larger than twice the size, and merged with
+		// the previous block when they fit in one.
+		const int BLOCK_SIZE = 256;
+
+	}
+
+	BlockedSums::BlockedSums() : size_(0) {
+	}
+
+	void BlockedSums::clear() {
+		blocks_.clear();
+		size_ = 0;
+	}
+
+	void BlockedSums::insert(int index, const float* values, int count) {
+		assert(index >= 0 && index <= size_);
+		if (count <= 0) {
+			return;
+		}
+		if (blocks_.empty()) {
+			blocks_.push_back(Block{{}, 0});
+		}
+		int b = findBlock(index);
+		std::vector<float>& blockValues = blocks_[b].values_;
+		blockValues.insert(blockValues.begin() + index, values, values + count);
+		size_ += count;
+
+		int size = (int) blockValues.size();
+		if (size <= 2 * BLOCK_SIZE) {
+			updateSum(blocks_[b]);
+			return;
+		}
+		std::vector<Block> parts;
+		for (int i = 0; i < size; i += BLOCK_SIZE) {
+			parts.push_back(Block{std::vector<float>(blockValues.begin() + i,
+				blockValues.begin() + std::min(i + BLOCK_SIZE, size)), 0});
+			updateSum(parts.back());
+		}
+		blocks_.erase(blocks_.begin() + b);
+		blocks_.insert(blocks_.begin() + b, parts.begin(), parts.end());
+	}
+
+	void BlockedSums::erase(int index, int count) {
+		assert(index >= 0 && count >= 0 && index + count <= size_);
+		if (count <= 0) {
+			return;
+		}
+		int b = findBlock(index);
+		while (count > 0) {
+			std::vector<float>& blockValues = blocks_[b].values_;
+			int n = std::min(count, (int) blockValues.size() - index);
+			blockValues.erase(blockValues.begin() + index, blockValues.begin() + index + n);
+			count -= n;
+			size_ -= n;
+			if (blockValues.empty()) {
+				blocks_.erase(blocks_.begin() + b);
+			} else {
+				updateSum(blocks_[b]);
+				++b;
+			}
+			index = 0;
+		}
+
+		// Keep the number of blocks down when erasing a little at a time.
+		if (b > 0 && b < (int) blocks_.size()
+			&& blocks_[b - 1].values_.size() + blocks_[b].values_.size() <= BLOCK_SIZE) {
+
+			std::vector<float>& previous = blocks_[b - 1].values_;
+			previous.insert(previous.end(), blocks_[b].values_.begin(), blocks_[b].values_.end());
+			updateSum(blocks_[b - 1]);
+			blocks_.erase(blocks_.begin() + b);
+		}
+	}
+
+	float BlockedSums::getSum(int index) const {
+		assert(index >= 0 && index <= size_);
+		float sum = 0;
+		for (const Block& block : blocks_) {
+			if (index < (int) block.values_.size()) {
+				float partial = 0;
+				for (int i = 0; i < index; ++i) {
+					partial += block.values_[i];
+				}
+				return sum + partial;
+			}
+			sum += block.sum_;
+			index -= (int) block.values_.size();
+		}
+		return sum;
+	}
+
+	int BlockedSums::lowerBound(float value) const {
+		if (0 >= value) {
+			return 0;
+		}
+		// Summed the same way as getSum(), i.e. the index found gives the same sum.
+		float sum = 0;
+		int first = 0;
+		for (const Block& block : blocks_) {
+			if (sum + block.sum_ >= value) {
+				float partial = 0;
+				for (int i = 0; i < (int) block.values_.size(); ++i) {
+					partial += block.values_[i];
+					if (sum + partial >= value) {
+						return first + i + 1;
+					}
+				}
+			}
+			sum += block.sum_;
+			first += (int) block.values_.size();
+		}
+		return size_ + 1;
+	}
+
+	int BlockedSums::findBlock(int& index) const {
+		int b = 0;
+		while (b + 1 < (int) blocks_.size() && index >= (int) blocks_[b].values_.size()) {
+			index -= (int) blocks_[b].values_.size();
+			++b;
+		}
+		return b;
+	}
+
+	void BlockedSums::updateSum(Block& block) {
+		block.sum_ = 0;
+		for (float value : block.values_) {
+			block.sum_ += value;
+		}
+	}
+
+} // Namespace gui.
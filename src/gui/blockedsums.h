@@ -0,0 +1,52 @@
+#ifndef GUI_BLOCKEDSUMS_H
+#define GUI_BLOCKEDSUMS_H
+
+#include <vector>
+
+namespace gui {
+
+	// A list of values stored in blocks, each block with the sum of its
+	// values. Inserting, erasing and summing only touch one block and walk
+	// the block sums, i.e. O(sqrt n) instead of rewriting all prefix sums.
+	class BlockedSums {
+	public:
+		BlockedSums();
+
+		void clear();
+
+		// Insert the count values at the index.
+		void insert(int index, const float* values, int count);
+
+		// Erase the count values at the index.
+		void erase(int index, int count);
+
+		// Return the sum of the values before the index, 0 <= index <= size.
+		float getSum(int index) const;
+
+		// Return the first index whose sum is at least the value, or
+		// size + 1 if none.
+		int lowerBound(float value) const;
+
+		int getSize() const {
+			return size_;
+		}
+
+	private:
+		struct Block {
+			std::vector<float> values_;
+			float sum_;
+		};
+
+		// Return the block holding the index, and set the index inside the block.
+		int findBlock(int& index) const;
+
+		// Sum the values in the same order as getSum().
+		static void updateSum(Block& block);
+
+		std::vector<Block> blocks_;
+		int size_;
+	};
+
+} // Namespace gui.
+
+#endif // GUI_BLOCKEDSUMS_H
@@ -0,0 +1,144 @@
+#include "bufferage.h"
+
+#include <SDL.h>
+
+#include <cstring>
+
+namespace gui {
+
+	namespace {
+
+		// From the EGL and GLX headers, loaded at run time to not link to either.
+		const int EGL_DRAW = 0x3059;
+		const int EGL_EXTENSIONS = 0x3055;
+		const int EGL_BUFFER_AGE_EXT = 0x313D;
+		const int GLX_SCREEN = 0x800C;
+		const int GLX_BACK_BUFFER_AGE_EXT = 0x20F4;
+
+		using EglGetCurrentContext = void* (*)();
+		using EglGetCurrentDisplay = void* (*)();
+		using EglGetCurrentSurface = void* (*)(int readDraw);
+		using EglQueryString = const char* (*)(void* display, int name);
+		using EglQuerySurface = unsigned int (*)(void* display, void* surface, int attribute, int* value);
+
+		using GlxGetCurrentContext = void* (*)();
+		using GlxGetCurrentDisplay = void* (*)();
+		using GlxGetCurrentDrawable = unsigned long (*)();
+		using GlxQueryContext = int (*)(void* display, void* context, int attribute, int* value);
+		using GlxQueryExtensionsString = const char* (*)(void* display, int screen);
+		using GlxQueryDrawable = void (*)(void* display, unsigned long drawable, int attribute, unsigned int* value);
+
+		bool hasExtension(const char* extensions, const char* name) {
+			size_t length = std::strlen(name);
+			for (const char* start = extensions; start != nullptr && (start = std::strstr(start, name)) != nullptr; start += length) {
+				bool first = start == extensions || start[-1] == ' ';
+				bool last = start[length] == ' ' || start[length] == 0;
+				if (first && last) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		struct Egl {
+			Egl() {
+				library_ = SDL_LoadObject("libEGL.so.1");
+				if (library_ != nullptr) {
+					getCurrentContext_ = (EglGetCurrentContext) SDL_LoadFunction(library_, "eglGetCurrentContext");
+					getCurrentDisplay_ = (EglGetCurrentDisplay) SDL_LoadFunction(library_, "eglGetCurrentDisplay");
+					getCurrentSurface_ = (EglGetCurrentSurface) SDL_LoadFunction(library_, "eglGetCurrentSurface");
+					queryString_ = (EglQueryString) SDL_LoadFunction(library_, "eglQueryString");
+					querySurface_ = (EglQuerySurface) SDL_LoadFunction(library_, "eglQuerySurface");
+				}
+			}
+
+			// Return -1 if no EGL context is current.
+			int getBufferAge() {
+				if (querySurface_ == nullptr || getCurrentContext_ == nullptr || getCurrentContext_() == nullptr) {
+					return -1;
+				}
+				void* display = getCurrentDisplay_();
+				if (display != display_) {
+					display_ = display;
+					supported_ = hasExtension(queryString_(display, EGL_EXTENSIONS), "EGL_EXT_buffer_age");
+				}
+				int age = 0;
+				if (!supported_ || querySurface_(display, getCurrentSurface_(EGL_DRAW), EGL_BUFFER_AGE_EXT, &age) == 0) {
+					return 0;
+				}
+				return age;
+			}
+
+			void* library_ = nullptr;
+			EglGetCurrentContext getCurrentContext_ = nullptr;
+			EglGetCurrentDisplay getCurrentDisplay_ = nullptr;
+			EglGetCurrentSurface getCurrentSurface_ = nullptr;
+			EglQueryString queryString_ = nullptr;
+			EglQuerySurface querySurface_ = nullptr;
+			void* display_ = nullptr;
+			bool supported_ = false;
+		};
+
+		struct Glx {
+			Glx() {
+				library_ = SDL_LoadObject("libGL.so.1");
+				if (library_ != nullptr) {
+					getCurrentContext_ = (GlxGetCurrentContext) SDL_LoadFunction(library_, "glXGetCurrentContext");
+					getCurrentDisplay_ = (GlxGetCurrentDisplay) SDL_LoadFunction(library_, "glXGetCurrentDisplay");
+					getCurrentDrawable_ = (GlxGetCurrentDrawable) SDL_LoadFunction(library_, "glXGetCurrentDrawable");
+					queryContext_ = (GlxQueryContext) SDL_LoadFunction(library_, "glXQueryContext");
+					queryExtensionsString_ = (GlxQueryExtensionsString) SDL_LoadFunction(library_, "glXQueryExtensionsString");
+					queryDrawable_ = (GlxQueryDrawable) SDL_LoadFunction(library_, "glXQueryDrawable");
+				}
+			}
+
+			// Return -1 if no GLX context is current.
+			int getBufferAge() {
+				if (queryDrawable_ == nullptr || getCurrentContext_ == nullptr) {
+					return -1;
+				}
+				void* context = getCurrentContext_();
+				if (context == nullptr) {
+					return -1;
+				}
+				void* display = getCurrentDisplay_();
+				if (context != context_) {
+					// Querying a unsupported attribute is a X error, check first.
+					context_ = context;
+					int screen = 0;
+					queryContext_(display, context, GLX_SCREEN, &screen);
+					supported_ = hasExtension(queryExtensionsString_(display, screen), "GLX_EXT_buffer_age");
+				}
+				if (!supported_) {
+					return 0;
+				}
+				unsigned int age = 0;
+				queryDrawable_(display, getCurrentDrawable_(), GLX_BACK_BUFFER_AGE_EXT, &age);
+				return (int) age;
+			}
+
+			void* library_ = nullptr;
+			GlxGetCurrentContext getCurrentContext_ = nullptr;
+			GlxGetCurrentDisplay getCurrentDisplay_ = nullptr;
+			GlxGetCurrentDrawable getCurrentDrawable_ = nullptr;
+			GlxQueryContext queryContext_ = nullptr;
+			GlxQueryExtensionsString queryExtensionsString_ = nullptr;
+			GlxQueryDrawable queryDrawable_ = nullptr;
+			void* context_ = nullptr;
+			bool supported_ = false;
+		};
+
+	}
+
+	int getBufferAge() {
+		static Egl egl;
+		int age = egl.getBufferAge();
+		if (age >= 0) {
+			return age;
+		}
+		static Glx glx;
+		age = glx.getBufferAge();
+		return age > 0 ? age : 0;
+	}
+
+} // Namespace gui.
@@ -0,0 +1,15 @@
+#ifndef GUI_BUFFERAGE_H
+#define GUI_BUFFERAGE_H
+
+namespace gui {
+
+	// Return the age of the current back buffer, i.e. the number of frames
+	// since its content was drawn. One means it holds the last frame. Zero
+	// if unknown, e.g. when the content is undefined after a swap or the
+	// platform has neither EGL_EXT_buffer_age nor GLX_EXT_buffer_age.
+	// Must be called before drawing to the back buffer.
+	int getBufferAge();
+
+} // Namespace gui.
+
+#endif // GUI_BUFFERAGE_H
@@ -5,15 +5,19 @@
 
 namespace gui {
 
-	Button::Button() : Button(mw::Text()) {
+	Button::Button() : Button(GlyphText()) {
 	}
 
-	Button::Button(std::string text, const mw::Font& font) : Button(mw::Text(text, font)) {
+	Button::Button(std::string text, const mw::Font& font) : Button(GlyphText(text, font)) {
 	}
 
-	Button::Button(mw::Text text) : text_(text), pushed_(false), mouseDown_(false), mouseInside_(false),
-		autoFit_(false), vTextAlignment_(VerticalAlignment::VCENTER), hTextAlignment_(HorizontalAlignment::HCENTER),
-		textColor_(0,0,0), focusColor_(0, 0, 0, 0.05f), hoverColor_(0, 0, 0, 0.1f), pushColor_(0, 0, 0, 0.15f) {
+	Button::Button(mw::Text text) : Button(GlyphText(text)) {
+	}
+
+	Button::Button(const GlyphText& text) : text_(text),
+		textColor_(0,0,0), hoverColor_(0, 0, 0, 0.1f), focusColor_(0, 0, 0, 0.05f), pushColor_(0, 0, 0, 0.15f),
+		vTextAlignment_(VerticalAlignment::VCENTER), hTextAlignment_(HorizontalAlignment::HCENTER),
+		autoFit_(false), pushed_(false), mouseDown_(false), mouseInside_(false) {
 		
 		setPreferredSize(50, 50);
 		setBackgroundColor(0.9f, 0.9f, 0.9f);
@@ -45,13 +49,15 @@ namespace gui {
 	// Set the label of this Button instance.
 	void Button::setLabel(std::string label) {
 		text_.setText(label);
+		repaint();
 		if (autoFit_) {
 			sizeToFitText();
 		}
 	}
 
 	void Button::setFont(const mw::Font& font) {
-		text_ = mw::Text(text_.getText(), font);
+		text_ = GlyphText(text_.getText(), font);
+		repaint();
 		if (autoFit_) {
 			sizeToFitText();
 		}
@@ -73,13 +79,17 @@ namespace gui {
 	void Button::handleMouse(const SDL_Event& mouseEvent) {
 		switch (mouseEvent.type) {
 			case SDL_MOUSEMOTION:
-				mouseInside_ = true;
+				if (!mouseInside_) {
+					mouseInside_ = true;
+					repaint();
+				}
 				break;
 			case SDL_MOUSEBUTTONDOWN:
 				switch (mouseEvent.button.button) {
 					case SDL_BUTTON_LEFT:
 						pushed_ = true;
 						mouseDown_ = true;
+						repaint();
 						break;
 				}
 				break;
@@ -90,6 +100,7 @@ namespace gui {
 							doAction();
 							mouseDown_ = false;
 							pushed_ = false;
+							repaint();
 						}
 						break;
 				}
@@ -111,28 +122,36 @@ namespace gui {
 	}
 
 	void Button::mouseMotionLeave() {
-		mouseInside_ = false;
+		if (mouseInside_) {
+			mouseInside_ = false;
+			repaint();
+		}
 	}
 
 	void Button::mouseOutsideUp() {
 		mouseDown_ = false;
 		pushed_ = false;
+		repaint();
 	}
 
 	void Button::setVerticalAlignment(VerticalAlignment alignment) {
 		vTextAlignment_ = alignment;
+		repaint();
 	}
 
 	void Button::setHorizontalAlignment(HorizontalAlignment alignment) {
 		hTextAlignment_ = alignment;
+		repaint();
 	}
 
 	void Button::setTextColor(const mw::Color& textColor) {
 		textColor_ = textColor;
+		repaint();
 	}
 
 	void Button::setTextColor(float red, float green, float blue, float alpha) {
 		textColor_ = mw::Color(red, green, blue, alpha);
+		repaint();
 	}
 
 	void Button::sizeToFitText() {
@@ -2,8 +2,10 @@
 #define GUI_BUTTON_H
 
 #include "component.h"
+#include "glyphtext.h"
 
 #include <mw/signal.h>
+#include <mw/font.h>
 #include <mw/text.h>
 
 #include <functional>
@@ -28,6 +30,7 @@ namespace gui {
 		Button();
 		Button(std::string text, const mw::Font& font);
 		Button(mw::Text text);
+		Button(const GlyphText& text);
 
 		virtual ~Button() = default;
 
@@ -79,10 +82,12 @@ namespace gui {
 
 		void setHoverColor(const mw::Color& color) {
 			hoverColor_ = color;
+			repaint();
 		}
 
 		void setHoverColor(float red, float green, float blue, float alpha = 1) {
 			hoverColor_ = mw::Color(red, green, blue, alpha);
+			repaint();
 		}
 
 		const mw::Color& getFocusColor() const {
@@ -91,10 +96,12 @@ namespace gui {
 
 		void setFocusColor(float red, float green, float blue, float alpha = 1) {
 			focusColor_ = mw::Color(red, green, blue, alpha);
+			repaint();
 		}
 
 		void setFocusColor(const mw::Color& color) {
 			focusColor_ = color;
+			repaint();
 		}
 
 		const mw::Color& getPushColor() const {
@@ -103,10 +110,12 @@ namespace gui {
 
 		void setPushColor(float red, float green, float blue, float alpha = 1) {
 			pushColor_ = mw::Color(red, green, blue, alpha);
+			repaint();
 		}
 
 		void setPushColor(const mw::Color& color) {
 			pushColor_ = color;
+			repaint();
 		}
 
 	protected:
@@ -127,7 +136,7 @@ namespace gui {
 
 		virtual void mouseOutsideUp() override;
 
-		mw::Text text_;
+		GlyphText text_;
 
 		mw::Color textColor_;
 		mw::Color hoverColor_;
@@ -49,6 +49,10 @@ namespace gui {
 	}
 
 	CheckBox::CheckBox(const mw::Text& text, const mw::Sprite& box, const mw::Sprite& check) :
+		CheckBox(GlyphText(text), box, check) {
+	}
+
+	CheckBox::CheckBox(const GlyphText& text, const mw::Sprite& box, const mw::Sprite& check) :
 		text_(text),
 		textColor_(0, 0, 0),
 		boxColor_(0, 0, 0),
@@ -66,6 +70,23 @@ namespace gui {
 		setBackgroundColor(1, 1, 1, 0);
 	}
 
+	void CheckBox::setBoxSprite(const mw::Sprite& box) {
+		box_ = box;
+		repaint();
+	}
+
+	void CheckBox::setCheckSprite(const mw::Sprite& check) {
+		check_ = check;
+		repaint();
+	}
+
+	void CheckBox::setFont(const mw::Font& font) {
+		text_ = GlyphText(text_.getText(), font);
+		boxSize_ = (float) font.getCharacterSize();
+		setPreferredSize(boxSize_ + text_.getWidth() + 1, text_.getHeight() + 2);
+		repaint();
+	}
+
 	void CheckBox::draw(const Graphic& graphic, double deltaTime) {
 		Component::draw(graphic, deltaTime);
 		graphic.setColor(boxColor_);
@@ -80,26 +101,32 @@ namespace gui {
 
 	void CheckBox::setTextColor(const mw::Color& color) {
 		textColor_ = color;
+		repaint();
 	}
 
 	void CheckBox::setTextColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
 		textColor_ = mw::Color(red, green, blue, alpha);
+		repaint();
 	}
 
 	void CheckBox::setBoxColor(const mw::Color& color) {
 		boxColor_ = color;
+		repaint();
 	}
 
 	void CheckBox::setBoxColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
 		boxColor_ = mw::Color(red, green, blue, alpha);
+		repaint();
 	}
 
 	void CheckBox::setCheckColor(const mw::Color& color) {
 		checkColor_ = color;
+		repaint();
 	}
 
 	void CheckBox::setCheckColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
 		checkColor_ = mw::Color(red, green, blue, alpha);
+		repaint();
 	}
 
 	void CheckBox::handleMouse(const SDL_Event& mouseEvent) {
@@ -2,6 +2,7 @@
 #define GUI_CHECKBOX_H
 
 #include "component.h"
+#include "glyphtext.h"
 
 #include <mw/font.h>
 #include <mw/text.h>
@@ -16,6 +17,7 @@ namespace gui {
 		CheckBox(float characterSize, const mw::Sprite& box, const mw::Sprite& check);
 		CheckBox(std::string text, const mw::Font& font, const mw::Sprite& box, const mw::Sprite& check);
 		CheckBox(const mw::Text& text, const mw::Sprite& box, const mw::Sprite& check);
+		CheckBox(const GlyphText& text, const mw::Sprite& box, const mw::Sprite& check);
 
 		virtual ~CheckBox() = default;
 
@@ -26,7 +28,10 @@ namespace gui {
 		}
 
 		inline void setSelected(bool select) {
-			selected_ = select;
+			if (selected_ != select) {
+				selected_ = select;
+				repaint();
+			}
 		}
 
 		// Set the color for the text label.
@@ -47,12 +52,19 @@ namespace gui {
 		// Set the check color.
 		void setCheckColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha = 1);
 
+		void setBoxSprite(const mw::Sprite& box);
+
+		void setCheckSprite(const mw::Sprite& check);
+
+		// Set the font used by the text label.
+		void setFont(const mw::Font& font);
+
 	private:
 		void handleMouse(const SDL_Event&) override;
 
-		mw::Text text_;
+		GlyphText text_;
 		mw::Color textColor_, boxColor_, checkColor_;
-		mw::Sprite box_, check_;
+		BoundSprite box_, check_;
 
 		float boxSize_;
 		bool selected_;
@@ -5,7 +5,7 @@ namespace gui {
 
 	namespace {
 	
-		float calculateTextAlignDeltaX(ComboBox::HorizontalAlign horizontalAlign, const mw::Text& text, Dimension dim) {
+		float calculateTextAlignDeltaX(ComboBox::HorizontalAlign horizontalAlign, const GlyphText& text, Dimension dim) {
 			float x = 0;
 			switch (horizontalAlign) {
 				case ComboBox::HorizontalAlign::LEFT:
@@ -46,21 +46,24 @@ namespace gui {
 
 	int ComboBox::addItem(std::string item) {
 		items_.emplace_back(item, font_);
+		repaint();
 		return items_.size() - 1;
 	}
 
 	void ComboBox::removeItem(std::string item) {
-		auto it = std::find_if(items_.begin(), items_.end(), [item](const mw::Text& text) {
+		auto it = std::find_if(items_.begin(), items_.end(), [item](const GlyphText& text) {
 			return item == text.getText();
 		});
 		if (it != items_.end()) {
 			items_.erase(it);
+			repaint();
 		}
 	}
 
 	void ComboBox::removeItem(unsigned int item) {
 		if (item >= 0 && item < items_.size()) {
 			items_.erase(items_.begin() + item);
+			repaint();
 		}
 	}
 
@@ -82,7 +85,7 @@ namespace gui {
 			graphic.setColor(getBackgroundColor());
 		}
 		graphic.drawSquare(x, y, dim.width_, dim.height_);
-		graphic.drawSprite(getBackground(), x, y, dim.width_, dim.height_);
+		graphic.drawSprite(getBoundBackground(), x, y, dim.width_, dim.height_);
 
 		graphic.setColor(getBorderColor());
 		graphic.drawBorder(x, y, dim.width_, dim.height_);
@@ -134,11 +137,13 @@ namespace gui {
 						case SDLK_DOWN:
 							selectedItem_ = (selectedItem_ + 1) % items_.size();
 							currentItem_ = selectedItem_;
+							repaint();
 							doAction();
 							break;
 						case SDLK_UP:
 							selectedItem_ = (selectedItem_ + items_.size() - 1) % items_.size();
 							currentItem_ = selectedItem_;
+							repaint();
 							doAction();
 							break;
 					}
@@ -152,13 +157,18 @@ namespace gui {
 			case SDL_MOUSEMOTION:
 				mouseInside_ = true;
 				if (pushed_) {
-					currentItem_ = (int) (items_.size() - mouseEvent.motion.y / originalSize_.height_);
+					int item = (int) (items_.size() - mouseEvent.motion.y / originalSize_.height_);
+					if (currentItem_ != item) {
+						currentItem_ = item;
+						repaint();
+					}
 				}
 				break;
 			case SDL_MOUSEBUTTONDOWN:
 				switch (mouseEvent.button.button) {
 					case SDL_BUTTON_LEFT:
 						pushed_ = true;
+						repaint();
 						demandPriority();
 						currentItem_ = selectedItem_;
 						originalSize_ = getSize();
@@ -175,6 +185,7 @@ namespace gui {
 							setSelectedItem(currentItem_); // Select the item, plus make sure that no invalid item is selected.
 							doAction();
 							pushed_ = false;
+							repaint();
 							setLocation(originalLocation_);
 							setSize(originalSize_);
 						}
@@ -198,16 +209,24 @@ namespace gui {
 
 	void ComboBox::mouseOutsideUp() {
 		pushed_ = false;
+		repaint();
 		setLocation(originalLocation_);
 		setSize(originalSize_);
 	}
 
 	void ComboBox::setShowDropDownColor(const mw::Color& color) {
 		showDropDownColor_ = color;
+		repaint();
 	}
 
 	void ComboBox::setShowDropDownColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
 		showDropDownColor_ = mw::Color(red, green, blue, alpha);
+		repaint();
+	}
+
+	void ComboBox::setShowDropDownSprite(const mw::Sprite& showDropDown) {
+		showDropDown_ = showDropDown;
+		repaint();
 	}
 
 } // Namespace gui.
@@ -2,8 +2,8 @@
 #define GUI_COMBOBOX_H
 
 #include "component.h"
+#include "glyphtext.h"
 
-#include <mw/text.h>
 #include <mw/font.h>
 
 #include <vector>
@@ -61,6 +61,8 @@ namespace gui {
 		// Set the check color.
 		void setShowDropDownColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha = 1);
 
+		void setShowDropDownSprite(const mw::Sprite& showDropDown);
+
 		// Returns true when the mouse is inside the button. Else 
 		// it returns false.
 		bool isMouseInside() const;
@@ -81,7 +83,7 @@ namespace gui {
 		virtual void draw(const Graphic& graphic, double deltaTime) override;
 
 	private:
-		std::vector<mw::Text> items_;
+		std::vector<GlyphText> items_;
 		mw::Color textColor_, markColor_;
 		mw::Color hoverColor_;
 		mw::Color focusColor_;
@@ -93,7 +95,7 @@ namespace gui {
 
 
 		mw::Font font_;
-		mw::Sprite showDropDown_;
+		BoundSprite showDropDown_;
 		HorizontalAlign textHorizontalAlign_;
 
 		int selectedItem_;
@@ -114,6 +116,7 @@ namespace gui {
 		if (item >= 0 && item < (int) items_.size()) {
 			if (selectedItem_ != item) {
 				selectedItem_ = item;
+				repaint();
 				doAction();
 			}
 		}
@@ -129,10 +132,12 @@ namespace gui {
 
 	inline void ComboBox::setTextColor(const mw::Color& color) {
 		textColor_ = color;
+		repaint();
 	}
 
 	inline void ComboBox::setTextColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
 		textColor_ = mw::Color(red, green, blue, alpha);
+		repaint();
 	}
 
 	inline mw::Color ComboBox::getTextColor() const {
@@ -145,26 +150,32 @@ namespace gui {
 
 	inline void ComboBox::setFocusColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
 		focusColor_ = mw::Color(red, green, blue, alpha);
+		repaint();
 	}
 
 	inline void ComboBox::setFocusColor(const mw::Color& color) {
 		focusColor_ = color;
+		repaint();
 	}
 
 	inline void ComboBox::setSelectedBackgroundColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
 		selectedBackgroundColor_ = mw::Color(red, green, blue, alpha);
+		repaint();
 	}
 
 	inline void ComboBox::setSelectedBackgroundColor(const mw::Color& color) {
 		selectedBackgroundColor_ = color;
+		repaint();
 	}
 
 	inline void ComboBox::setSelectedTextColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
 		selectedTextColor_ = mw::Color(red, green, blue, alpha);
+		repaint();
 	}
 
 	inline void ComboBox::setSelectedTextColor(const mw::Color& color) {
 		selectedTextColor_ = color;
+		repaint();
 	}
 
 	inline int ComboBox::getItemCount() const {
@@ -7,33 +7,50 @@
 
 namespace gui {
 
+	thread_local Component::SubtreeLayout* Component::subtreeLayout_ = nullptr;
+
 	void Component::setLocation(float x, float y) {
 		setLocation(Point(x, y));
 	}
 
 	void Component::setLocation(const Point& point) {
+		if (location_.x_ != point.x_ || location_.y_ != point.y_) {
+			repaintParent();
+			invalidateParentHitGrid();
+		}
 		location_ = point;
-		if (parent_ != nullptr) {
-			model_ = parent_->model_;
-		} else {
-			model_ = mw::Matrix44f::I;
+		updateModelMatrix();
+	}
+
+	void Component::setSize(float width, float height) {
+		setSize(Dimension(width, height));
+	}
+
+	void Component::setSize(const Dimension& dimension) {
+		if (dimension_.width_ != dimension.width_ || dimension_.height_ != dimension.height_) {
+			repaintParent();
+			invalidateParentHitGrid();
+			dimension_ = dimension;
+			// The children must fit the new size.
+			invalidate();
 		}
-		mw::translate2D(model_, point.x_, point.y_);
 	}
 
 	void Component::setPreferredSize(float width, float height) {
-		preferedDimension_ = Dimension(width, height);
-		validateParent();
+		setPreferredSize(Dimension(width, height));
 	}
 
 	void Component::setPreferredSize(const Dimension& dimension) {
-		preferedDimension_ = dimension;
-		validateParent();
+		if (preferedDimension_.width_ != dimension.width_ || preferedDimension_.height_ != dimension.height_) {
+			preferedDimension_ = dimension;
+			validateParent();
+		}
 	}
 
 	void Component::setVisible(bool visible) {
 		if (visible_ != visible) {
 			visible_ = visible;
+			repaintParent();
 			validateParent();
 		}
 	}
@@ -66,20 +83,18 @@ namespace gui {
 		// Change?
 		if (focus_ != focus) {
 			focus_ = focus;
+			repaint();
 			focusListener_(*this);
-			if (parent_ && focus) {
-				std::static_pointer_cast<Component>(parent_)->setFocus(focus, shared_from_this());
+			if (parent_ != nullptr) {
+				if (focus) {
+					parent_->childFocusGained(*this);
+				} else {
+					parent_->childFocusLost(*this);
+				}
 			}
 		}
 	}
 
-	void Component::setFocus(bool focus, const std::shared_ptr<Component>& parent) {
-		if (focus_ != focus) {
-			focus_ = focus;
-			focusListener_(*this);
-		}
-	}
-
 	bool Component::hasFocus() const {
 		return focus_;
 	}
@@ -109,11 +124,17 @@ namespace gui {
 		layoutIndex_ = layoutIndex;
 	}
 	
-	Component::Component() : parent_(nullptr), ancestor_(nullptr),
-		borderColor_(0, 0, 0), backgroundColor_(1, 1, 1), layoutIndex_(0), visible_(true),
-		focus_(false), isAdded_(false),
-		model_(mw::Matrix44f::I) {
+	Component::Component() : parent_(nullptr),
+		backgroundColor_(1, 1, 1), borderColor_(0, 0, 0), layoutIndex_(0), visible_(true),
+		focus_(false), isAdded_(false), dirty_(true), descendantDirty_(false), modified_(true),
+		layoutDirty_(true), descendantLayoutDirty_(false), serialLayouts_(0), model_(mw::Matrix44f::I) {
+
+	}
 
+	void Component::setSerialLayout() {
+		for (Component* component = this; component != nullptr; component = component->parent_) {
+			++component->serialLayouts_;
+		}
 	}
 
 	void Component::handleMouse(const SDL_Event& mouseEvent) {
@@ -125,20 +146,68 @@ namespace gui {
 	}
 
 	void Component::validateParent() {
+		if (isSubtreeRoot(this)) {
+			subtreeLayout_->validateParent_ = true;
+		} else if (parent_ != nullptr) {
+			parent_->invalidate();
+		}
+	}
+
+	void Component::invalidate() {
+		layoutDirty_ = true;
+		// Mark the path to the root. Stop at the first marked ancestor,
+		// the rest of the path is already marked.
+		Component* ancestor = parent_;
+		while (ancestor != nullptr && !ancestor->descendantLayoutDirty_) {
+			ancestor->descendantLayoutDirty_ = true;
+			ancestor = ancestor->parent_;
+		}
+	}
+
+	void Component::layout() {
+		if (layoutDirty_) {
+			layoutDirty_ = false;
+			validate();
+		}
+		descendantLayoutDirty_ = false;
+	}
+
+	void Component::updateModelMatrix() {
 		if (parent_ != nullptr) {
-			parent_->validate();
+			model_ = parent_->model_;
+		} else {
+			model_ = mw::Matrix44f::I;
+		}
+		mw::translate2D(model_, location_.x_, location_.y_);
+	}
+
+	std::shared_ptr<Panel> Component::getParent() const {
+		if (parent_ == nullptr) {
+			return nullptr;
 		}
+		return std::static_pointer_cast<Panel>(parent_->shared_from_this());
+	}
+
+	std::shared_ptr<Panel> Component::getAncestor() const {
+		if (parent_ == nullptr) {
+			return nullptr;
+		}
+		Panel* ancestor = parent_;
+		while (ancestor->parent_ != nullptr) {
+			ancestor = ancestor->parent_;
+		}
+		return std::static_pointer_cast<Panel>(ancestor->shared_from_this());
 	}
 
 	void Component::demandPriority() {
-		if (getParent() != nullptr) {
-			getParent()->demandPriority(shared_from_this());
+		if (parent_ != nullptr) {
+			parent_->demandPriority(shared_from_this());
 		}
 	}
 
 	void Component::releasePriority() {
-		if (getParent() != nullptr) {
-			getParent()->releasePriority(shared_from_this());
+		if (parent_ != nullptr) {
+			parent_->releasePriority(shared_from_this());
 		}
 	}
 
@@ -146,4 +215,53 @@ namespace gui {
 		drawListener_(frame, deltaTime);
 	}
 
+	Rect Component::getWindowRect() const {
+		// The model matrix only translates in 2D.
+		const float* m = model_.data();
+		return Rect(m[12], m[13], dimension_.width_, dimension_.height_);
+	}
+
+	void Component::repaint() {
+		dirty_ = true;
+		modified_ = true;
+		repaintAncestors();
+	}
+
+	void Component::repaintAncestors() {
+		Component* component = this;
+		while (component->parent_ != nullptr) {
+			if (isSubtreeRoot(component)) {
+				subtreeLayout_->repaintAncestors_ = true;
+				return;
+			}
+			component = component->parent_;
+			component->descendantDirty_ = true;
+			component->modified_ = true;
+		}
+	}
+
+	void Component::repaintParent() {
+		if (isSubtreeRoot(this)) {
+			subtreeLayout_->repaintParent_ = true;
+		} else if (parent_ != nullptr) {
+			parent_->repaint();
+		}
+	}
+
+	void Component::invalidateParentHitGrid() {
+		if (isSubtreeRoot(this)) {
+			subtreeLayout_->invalidateHitGrid_ = true;
+		} else if (parent_ != nullptr) {
+			parent_->hitGridValid_ = false;
+		}
+	}
+
+	void Component::collectDirtyRegion(Rect& region, bool covered) {
+		if (dirty_ && !covered && visible_) {
+			region = region.unite(getWindowRect());
+		}
+		dirty_ = false;
+		descendantDirty_ = false;
+	}
+
 } // Namespace gui.
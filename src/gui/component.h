@@ -57,13 +57,9 @@ namespace gui {
 			return dimension_;
 		}
 
-		void setSize(float width, float height) {
-			dimension_ = Dimension(width, height);
-		}
+		void setSize(float width, float height);
 
-		void setSize(const Dimension& dimension) {
-			dimension_ = dimension;
-		}
+		void setSize(const Dimension& dimension);
 
 		void setVisible(bool visible);
 
@@ -80,33 +76,36 @@ namespace gui {
 
 		// Set the focus for the component.
 		// The focus listener is called if the focus changes.
+		// Gaining focus gives the parents focus and takes it from the
+		// previously focused component.
 		virtual void setFocus(bool focus);
 
 		// Return the focus for the component.
 		bool hasFocus() const;
 
-		std::shared_ptr<Panel> getParent() const {
-			return parent_;
-		}
+		// Return the panel the component is added to, or null.
+		std::shared_ptr<Panel> getParent() const;
 
-		std::shared_ptr<Panel> getAncestor() const {
-			return parent_;
-		}
+		// Return the top most panel the component is part of, or null.
+		std::shared_ptr<Panel> getAncestor() const;
 
 		void setBackground(const mw::Sprite& background) {
 			background_ = background;
+			repaint();
 		}
 
 		const mw::Sprite& getBackground() const {
-			return background_;
+			return background_.getSprite();
 		}
 
 		void setBackgroundColor(const mw::Color& color) {
 			backgroundColor_ = color;
+			repaint();
 		}
 
 		void setBackgroundColor(float red, float green, float blue, float alpha = 1) {
 			backgroundColor_ = mw::Color(red, green, blue, alpha);
+			repaint();
 		}
 
 		const mw::Color& getBackgroundColor() const {
@@ -115,10 +114,12 @@ namespace gui {
 
 		void setBorderColor(const mw::Color& color) {
 			borderColor_ = color;
+			repaint();
 		}
 
 		void setBorderColor(float red, float green, float blue, float alpha = 1) {
 			borderColor_ = mw::Color(red, green, blue, alpha);
+			repaint();
 		}
 
 		const mw::Color& getBorderColor() const {
@@ -139,12 +140,36 @@ namespace gui {
 		const mw::Matrix44f& getModelMatrix() {
 			return model_;
 		}
+
+		// Return the component's location and size in window coordinates.
+		Rect getWindowRect() const;
+
+		// Mark the component to be drawn again. Must be called when
+		// something changes the appearance of the component.
+		void repaint();
+
+		// Return true if the component is marked to be drawn again.
+		bool isDirty() const {
+			return dirty_;
+		}
+
+		// Mark the component to be laid out again. The layout is deferred
+		// and done once for all marked components, before the next draw.
+		void invalidate();
+
+		// Return true if the component is marked to be laid out again.
+		bool isInvalid() const {
+			return layoutDirty_;
+		}
 		
 	protected:
-		virtual void setFocus(bool focus, const std::shared_ptr<Component>& parent);
-
 		Component();
 
+		// Return the child on the focus path, null if none.
+		virtual Component* getFocusedChild() const {
+			return nullptr;
+		}
+
 		virtual void init() {
 		}
 
@@ -154,15 +179,20 @@ namespace gui {
 		virtual void draw(const Graphic& graphic, double deltaTime);
 	
 		// Is called in order to signal the parent component that
-		// the children's sizes must be recalculated.
+		// the children's sizes must be recalculated. The layout is deferred,
+		// see invalidate().
 		void validateParent();
 
-		virtual void setChildsParent() {
-		}
+		// Lay out the component and all descendants marked by invalidate().
+		virtual void layout();
+
+		// Update the model matrix from the parent's model matrix and the location.
+		virtual void updateModelMatrix();
 
 		// Take care of all mouse events. And send it through to
 		// all mouse listener callbacks.
-		// Mouse events: SDL_MOUSEMOTION, SDL_MOUSEBUTTONDOWN and SDL_MOUSEBUTTONUP.
+		// Mouse events: SDL_MOUSEMOTION, SDL_MOUSEBUTTONDOWN, SDL_MOUSEBUTTONUP
+		// and SDL_MOUSEWHEEL.
 		virtual void handleMouse(const SDL_Event& mouseEvent);
 
 		// Take care of all key events. And send it through to
@@ -196,11 +226,56 @@ namespace gui {
 
 		virtual void drawListener(Frame& frame, double deltaTime);
 
+		// Add the window rectangles of all components marked to be drawn again
+		// to the region, and unmark them. If covered is true, the region already
+		// contains the component.
+		virtual void collectDirtyRegion(Rect& region, bool covered);
+
+		// Mark the parent to be drawn again.
+		void repaintParent();
+
+		// Call once, from the constructor of a component whose validate() does
+		// more than placing the children, e.g. calls user callbacks or lays out
+		// text. The subtree is then never laid out by a pool thread, see
+		// Panel::setParallelLayout().
+		void setSerialLayout();
+
+		// Return the background, with the texture id kept between the draws.
+		const BoundSprite& getBoundBackground() const {
+			return background_;
+		}
+
 	private:
-		std::shared_ptr<Panel> parent_;
-		std::shared_ptr<Panel> ancestor_;
+		// Changes to the ancestors of a subtree laid out by a pool thread.
+		// The ancestors are shared with the other subtrees, the changes are
+		// applied by the parent when all subtrees are laid out.
+		struct SubtreeLayout {
+			Component* root_;
+			bool repaintAncestors_;
+			bool repaintParent_;
+			bool validateParent_;
+			bool invalidateHitGrid_;
+		};
+
+		// Return true if the component is the root of the subtree laid out
+		// by the current thread.
+		static bool isSubtreeRoot(const Component* component) {
+			return subtreeLayout_ != nullptr && subtreeLayout_->root_ == component;
+		}
+
+		// The parent must update the grid used to find the component under the mouse.
+		void invalidateParentHitGrid();
+
+		// Mark the path to the root, invalidates all cached panels on the way.
+		void repaintAncestors();
+
+		static thread_local SubtreeLayout* subtreeLayout_;
+
+		// Not owning, the parent owns the component. Set by Panel when added
+		// and cleared when removed.
+		Panel* parent_;
 
-		mw::Sprite background_;
+		BoundSprite background_;
 		mw::Color backgroundColor_;
 		mw::Color borderColor_;
 		Point location_;
@@ -219,6 +294,12 @@ namespace gui {
 		bool focus_;
 
 		bool isAdded_;
+		bool dirty_;
+		bool descendantDirty_;
+		bool modified_; // Component or descendant repainted since last drawn.
+		bool layoutDirty_;
+		bool descendantLayoutDirty_;
+		int serialLayouts_; // Components in the subtree calling setSerialLayout().
 		mw::Matrix44f model_;
 	};
 
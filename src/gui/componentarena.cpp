@@ -0,0 +1,60 @@
+#include "componentarena.h"
+
+#include <cassert>
+#include <new>
+
+namespace gui {
+
+	ComponentArena::ComponentArena(size_t blockSize) : blockSize_(blockSize),
+		blockUsed_(blockSize), usedBytes_(0) {
+	}
+
+	ComponentArena::~ComponentArena() {
+		for (char* block : blocks_) {
+			::operator delete(block);
+		}
+	}
+
+	void* ComponentArena::allocate(size_t bytes) {
+		size_t size = (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+		if (size > blockSize_ / 4) {
+			// Too large to share a block.
+			return ::operator new(bytes);
+		}
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		usedBytes_ += size;
+		size_t sizeClass = size / ALIGNMENT;
+		if (sizeClass < freeLists_.size() && !freeLists_[sizeClass].empty()) {
+			void* pointer = freeLists_[sizeClass].back();
+			freeLists_[sizeClass].pop_back();
+			return pointer;
+		}
+
+		if (blockUsed_ + size > blockSize_) {
+			blocks_.push_back(static_cast<char*>(::operator new(blockSize_)));
+			blockUsed_ = 0;
+		}
+		void* pointer = blocks_.back() + blockUsed_;
+		blockUsed_ += size;
+		return pointer;
+	}
+
+	void ComponentArena::deallocate(void* pointer, size_t bytes) {
+		size_t size = (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+		if (size > blockSize_ / 4) {
+			::operator delete(pointer);
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		assert(usedBytes_ >= size);
+		usedBytes_ -= size;
+		size_t sizeClass = size / ALIGNMENT;
+		if (sizeClass >= freeLists_.size()) {
+			freeLists_.resize(sizeClass + 1);
+		}
+		freeLists_[sizeClass].push_back(pointer);
+	}
+
+} // Namespace gui.
@@ -0,0 +1,95 @@
+#ifndef GUI_COMPONENTARENA_H
+#define GUI_COMPONENTARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace gui {
+
+	// Allocates components from large blocks, i.e. components created
+	// together are placed next to each other in memory. Freed memory is
+	// reused by later components of the same size class. The memory is
+	// returned to the system when the arena is destroyed.
+	// Thread safe, components may be created by a parallel layout pass.
+	class ComponentArena {
+	public:
+		ComponentArena(size_t blockSize = 64 * 1024);
+
+		~ComponentArena();
+
+		ComponentArena(const ComponentArena&) = delete;
+		ComponentArena& operator=(const ComponentArena&) = delete;
+
+		void* allocate(size_t bytes);
+
+		void deallocate(void* pointer, size_t bytes);
+
+		// Return the number of bytes in use.
+		size_t getUsedBytes() const {
+			std::lock_guard<std::mutex> lock(mutex_);
+			return usedBytes_;
+		}
+
+		// Return the number of blocks allocated from the system.
+		int getBlockCount() const {
+			std::lock_guard<std::mutex> lock(mutex_);
+			return (int) blocks_.size();
+		}
+
+	private:
+		static const size_t ALIGNMENT = alignof(std::max_align_t);
+
+		size_t blockSize_;
+		std::vector<char*> blocks_;
+		size_t blockUsed_; // Bytes used in the last block.
+		std::vector<std::vector<void*>> freeLists_; // One for each size class.
+		size_t usedBytes_;
+		mutable std::mutex mutex_;
+	};
+
+	// Standard allocator using a shared ComponentArena, e.g. for
+	// std::allocate_shared. The arena lives as long as any allocator
+	// referencing it, i.e. as long as any component allocated from it.
+	template <class T>
+	class ArenaAllocator {
+	public:
+		using value_type = T;
+
+		ArenaAllocator(const std::shared_ptr<ComponentArena>& arena) : arena_(arena) {
+		}
+
+		template <class U>
+		ArenaAllocator(const ArenaAllocator<U>& allocator) : arena_(allocator.getArena()) {
+		}
+
+		T* allocate(size_t n) {
+			return static_cast<T*>(arena_->allocate(n * sizeof(T)));
+		}
+
+		void deallocate(T* pointer, size_t n) {
+			arena_->deallocate(pointer, n * sizeof(T));
+		}
+
+		const std::shared_ptr<ComponentArena>& getArena() const {
+			return arena_;
+		}
+
+		template <class U>
+		bool operator==(const ArenaAllocator<U>& allocator) const {
+			return arena_ == allocator.getArena();
+		}
+
+		template <class U>
+		bool operator!=(const ArenaAllocator<U>& allocator) const {
+			return arena_ != allocator.getArena();
+		}
+
+	private:
+		std::shared_ptr<ComponentArena> arena_;
+	};
+
+} // Namespace gui.
+
+#endif // GUI_COMPONENTARENA_H
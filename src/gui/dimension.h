@@ -3,6 +3,8 @@
 
 #include <mw/vec2.h>
 
+#include <algorithm>
+
 namespace gui {
 
 	using Point = mw::Vec2<float>;
@@ -23,6 +25,57 @@ namespace gui {
 		float height_;
 	};
 
+	class Rect {
+	public:
+		Rect() : x_(0), y_(0), width_(0), height_(0) {
+		}
+
+		Rect(float x, float y, float width, float height) : x_(x), y_(y), width_(width), height_(height) {
+		}
+
+		bool isEmpty() const {
+			return width_ <= 0 || height_ <= 0;
+		}
+
+		bool contains(float x, float y) const {
+			return x_ <= x && x_ + width_ > x && y_ <= y && y_ + height_ > y;
+		}
+
+		bool intersects(const Rect& rect) const {
+			return x_ < rect.x_ + rect.width_ && rect.x_ < x_ + width_
+				&& y_ < rect.y_ + rect.height_ && rect.y_ < y_ + height_;
+		}
+
+		// Return the rectangle contained by both rectangles. Is empty if
+		// the rectangles do not intersect.
+		Rect intersect(const Rect& rect) const {
+			float x = std::max(x_, rect.x_);
+			float y = std::max(y_, rect.y_);
+			return Rect(x, y,
+				std::max(std::min(x_ + width_, rect.x_ + rect.width_) - x, 0.f),
+				std::max(std::min(y_ + height_, rect.y_ + rect.height_) - y, 0.f));
+		}
+
+		// Return the smallest rectangle containing both rectangles.
+		// Empty rectangles are ignored.
+		Rect unite(const Rect& rect) const {
+			if (rect.isEmpty()) {
+				return *this;
+			}
+			if (isEmpty()) {
+				return rect;
+			}
+			float x = std::min(x_, rect.x_);
+			float y = std::min(y_, rect.y_);
+			return Rect(x, y,
+				std::max(x_ + width_, rect.x_ + rect.width_) - x,
+				std::max(y_ + height_, rect.y_ + rect.height_) - y);
+		}
+
+		float x_, y_;
+		float width_, height_;
+	};
+
 } // Namespace gui.
 
 #endif // GUI_DIMENSION_H
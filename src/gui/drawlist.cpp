@@ -0,0 +1,197 @@
+#include "drawlist.h"
+#include "recttransform.h"
+
+#include <algorithm>
+
+namespace gui {
+
+	namespace {
+
+		// Number of batches a quad may be moved past, when looking for a
+		// batch with the same texture.
+		const int MAX_LOOKBACK = 16;
+
+		const char* KIND_NAMES[] = {"rect", "sprite", "text", "push_clip", "pop_clip", "push_window_clip"};
+
+		bool isQuad(DrawList::Kind kind) {
+			return kind == DrawList::RECT || kind == DrawList::SPRITE || kind == DrawList::TEXT;
+		}
+
+		template <class T>
+		void writeValue(std::ostream& out, const T& value) {
+			out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+		}
+
+	}
+
+	DrawList::DrawList() : transform_{0, 1, 1, 0, 0}, transformed_(false) {
+	}
+
+	void DrawList::clear() {
+		commands_.clear();
+		rects_.clear();
+		transforms_.clear();
+		transformed_ = false;
+	}
+
+	void DrawList::setTransform(float scaleX, float scaleY, float x, float y) {
+		transform_.scaleX_ = scaleX;
+		transform_.scaleY_ = scaleY;
+		transform_.x_ = x;
+		transform_.y_ = y;
+	}
+
+	void DrawList::addQuad(float x, float y, float w, float h, const mw::Color& color) {
+		add(Command{RECT, 0, 0, 0, 0, 0, color}, x, y, w, h, transform_);
+	}
+
+	void DrawList::addQuad(Kind kind, float x, float y, float w, float h,
+		float u, float v, float u2, float v2,
+		const mw::Color& color, GLuint texture) {
+
+		add(Command{kind, texture, u, v, u2, v2, color}, x, y, w, h, transform_);
+	}
+
+	void DrawList::pushClip(const Rect& rect, bool intersect) {
+		// Already in window coordinates.
+		add(Command{intersect ? PUSH_CLIP : PUSH_WINDOW_CLIP, 0, 0, 0, 0, 0, mw::Color()}, rect.x_, rect.y_, rect.width_, rect.height_,
+			Transform{0, 1, 1, 0, 0});
+	}
+
+	void DrawList::popClip() {
+		add(Command{POP_CLIP, 0, 0, 0, 0, 0, mw::Color()}, 0, 0, 0, 0, Transform{0, 1, 1, 0, 0});
+	}
+
+	void DrawList::add(const Command& command, float x, float y, float w, float h, const Transform& transform) {
+		if (transforms_.empty() || transforms_.back().scaleX_ != transform.scaleX_ || transforms_.back().scaleY_ != transform.scaleY_
+			|| transforms_.back().x_ != transform.x_ || transforms_.back().y_ != transform.y_) {
+
+			transforms_.push_back(transform);
+			transforms_.back().first_ = (int) commands_.size();
+		}
+		commands_.push_back(command);
+		rects_.insert(rects_.end(), {x, y, w, h});
+	}
+
+	void DrawList::transform() {
+		if (transformed_) {
+			return;
+		}
+		int size = (int) commands_.size();
+		for (unsigned int i = 0; i < transforms_.size(); ++i) {
+			const Transform& run = transforms_[i];
+			int end = i + 1 < transforms_.size() ? transforms_[i + 1].first_ : size;
+			transformRects(rects_.data() + run.first_ * 4, end - run.first_,
+				run.scaleX_, run.scaleY_, run.x_, run.y_);
+		}
+		transformed_ = true;
+	}
+
+	void DrawList::sort() {
+		transform();
+
+		int size = (int) commands_.size();
+		next_.assign(size, -1);
+		sortedCommands_.clear();
+		sortedRects_.clear();
+
+		int index = 0;
+		while (index < size) {
+			// Quads between two clip commands are ordered together.
+			batches_.clear();
+			for (; index < size && isQuad(commands_[index].kind_); ++index) {
+				const Command& command = commands_[index];
+				Rect rect = getRect(index);
+
+				int target = -1;
+				int stop = std::max(0, (int) batches_.size() - MAX_LOOKBACK);
+				for (int i = (int) batches_.size() - 1; i >= stop; --i) {
+					const Batch& batch = batches_[i];
+					// Quads without texture fits in any batch.
+					if (command.texture_ == 0 || batch.texture_ == 0 || batch.texture_ == command.texture_) {
+						target = i;
+						break;
+					}
+					// Must be drawn after the overlapped quads.
+					if (batch.bounds_.intersects(rect)) {
+						break;
+					}
+				}
+
+				if (target < 0) {
+					batches_.push_back(Batch{command.texture_, rect, index, index});
+				} else {
+					Batch& batch = batches_[target];
+					if (batch.texture_ == 0) {
+						batch.texture_ = command.texture_;
+					}
+					batch.bounds_ = batch.bounds_.unite(rect);
+					next_[batch.last_] = index;
+					batch.last_ = index;
+				}
+			}
+
+			for (const Batch& batch : batches_) {
+				for (int i = batch.first_; i >= 0; i = next_[i]) {
+					sortedCommands_.push_back(commands_[i]);
+					sortedRects_.insert(sortedRects_.end(), rects_.begin() + i * 4, rects_.begin() + i * 4 + 4);
+				}
+			}
+
+			if (index < size) {
+				// The clip command.
+				sortedCommands_.push_back(commands_[index]);
+				sortedRects_.insert(sortedRects_.end(), rects_.begin() + index * 4, rects_.begin() + index * 4 + 4);
+				++index;
+			}
+		}
+
+		commands_.swap(sortedCommands_);
+		rects_.swap(sortedRects_);
+	}
+
+	int DrawList::getTextureChanges() const {
+		int changes = 0;
+		GLuint texture = 0;
+		for (const Command& command : commands_) {
+			if (command.texture_ != 0) {
+				if (texture != 0 && texture != command.texture_) {
+					++changes;
+				}
+				texture = command.texture_;
+			}
+		}
+		return changes;
+	}
+
+	void DrawList::write(std::ostream& out) const {
+		for (int i = 0; i < getSize(); ++i) {
+			const Command& command = commands_[i];
+			Rect rect = getRect(i);
+			out << KIND_NAMES[command.kind_] << " " << rect.x_ << " " << rect.y_ << " " << rect.width_ << " " << rect.height_;
+			if (isQuad(command.kind_)) {
+				out << " color " << command.color_.red_ << " " << command.color_.green_
+					<< " " << command.color_.blue_ << " " << command.color_.alpha_;
+			}
+			if (command.texture_ != 0) {
+				out << " texture " << command.texture_ << " uv " << command.u_ << " " << command.v_
+					<< " " << command.u2_ << " " << command.v2_;
+			}
+			out << "\n";
+		}
+	}
+
+	void DrawList::writeBinary(std::ostream& out) const {
+		writeValue(out, (Uint32) commands_.size());
+		for (int i = 0; i < getSize(); ++i) {
+			const Command& command = commands_[i];
+			writeValue(out, (Uint8) command.kind_);
+			writeValue(out, (Uint32) command.texture_);
+			out.write(reinterpret_cast<const char*>(rects_.data() + i * 4), 4 * sizeof(float));
+			float values[] = {command.u_, command.v_, command.u2_, command.v2_,
+				command.color_.red_, command.color_.green_, command.color_.blue_, command.color_.alpha_};
+			out.write(reinterpret_cast<const char*>(values), sizeof(values));
+		}
+	}
+
+} // Namespace gui.
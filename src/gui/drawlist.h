@@ -0,0 +1,125 @@
+#ifndef GUI_DRAWLIST_H
+#define GUI_DRAWLIST_H
+
+#include "dimension.h"
+
+#include <mw/opengl.h>
+#include <mw/color.h>
+
+#include <SDL.h>
+
+#include <ostream>
+#include <vector>
+
+namespace gui {
+
+	// The drawing of a frame recorded as a flat list of commands, i.e. quads
+	// and clip changes. The list is ordered by texture, as far as the drawing
+	// order allows, and then drawn by Graphic. The memory is reused between
+	// frames. The list can be written as text or binary data, e.g. to compare
+	// frames in tests without reading back pixels.
+	class DrawList {
+	public:
+		enum Kind : Uint8 {
+			RECT,
+			SPRITE,
+			TEXT,
+			PUSH_CLIP,
+			POP_CLIP,
+			PUSH_WINDOW_CLIP // Replaces the clip rectangle instead of limiting it.
+		};
+
+		struct Command {
+			Kind kind_;
+			GLuint texture_; // 0 if none.
+			float u_, v_, u2_, v2_;
+			mw::Color color_;
+		};
+
+		DrawList();
+
+		// Remove all commands, the memory is kept.
+		void clear();
+
+		// Set the transform used by the quads added after this call. The
+		// position is scaled and then translated to window coordinates.
+		void setTransform(float scaleX, float scaleY, float x, float y);
+
+		// Add a quad without texture.
+		void addQuad(float x, float y, float w, float h, const mw::Color& color);
+
+		// Add a textured quad, (u, v) is the texture coordinate in the lower
+		// left corner and (u2, v2) in the upper right corner.
+		void addQuad(Kind kind, float x, float y, float w, float h,
+			float u, float v, float u2, float v2,
+			const mw::Color& color, GLuint texture);
+
+		// The rectangle is in window coordinates. The current clip rectangle
+		// is replaced if intersect is false.
+		void pushClip(const Rect& rect, bool intersect = true);
+
+		void popClip();
+
+		// Move the quads to window coordinates and order them by texture.
+		// Overlapping quads keep their order, and no quad is moved past a
+		// clip command.
+		void sort();
+
+		// Move the quads to window coordinates, keep the order.
+		void transform();
+
+		int getSize() const {
+			return (int) commands_.size();
+		}
+
+		const Command& getCommand(int index) const {
+			return commands_[index];
+		}
+
+		// Return the rectangle, in window coordinates after transform() or sort().
+		Rect getRect(int index) const {
+			const float* rect = rects_.data() + index * 4;
+			return Rect(rect[0], rect[1], rect[2], rect[3]);
+		}
+
+		// Return the number of times the texture changes between the quads,
+		// i.e. the least number of draw calls.
+		int getTextureChanges() const;
+
+		// Write one command per line.
+		void write(std::ostream& out) const;
+
+		void writeBinary(std::ostream& out) const;
+
+	private:
+		struct Transform {
+			int first_;
+			float scaleX_, scaleY_;
+			float x_, y_;
+		};
+
+		// Quads drawn together, linked through next_.
+		struct Batch {
+			GLuint texture_;
+			Rect bounds_;
+			int first_, last_;
+		};
+
+		void add(const Command& command, float x, float y, float w, float h, const Transform& transform);
+
+		std::vector<Command> commands_;
+		std::vector<float> rects_; // Position and size of each command.
+		std::vector<Transform> transforms_;
+		Transform transform_;
+		bool transformed_;
+
+		// Used by sort(), kept to avoid allocations each frame.
+		std::vector<Batch> batches_;
+		std::vector<int> next_;
+		std::vector<Command> sortedCommands_;
+		std::vector<float> sortedRects_;
+	};
+
+} // Namespace gui.
+
+#endif // GUI_DRAWLIST_H
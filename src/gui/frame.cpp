@@ -1,5 +1,6 @@
 #include "frame.h"
 #include "borderlayout.h"
+#include "bufferage.h"
 
 #include <mw/font.h>
 #include <mw/window.h>
@@ -7,10 +8,44 @@
 
 #include <string>
 #include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
 
 namespace gui {
 
-	Frame::Frame() : defaultClosing_(false), currentPanel_(0) {
+	namespace {
+
+		using Clock = std::chrono::high_resolution_clock;
+
+		// Return the seconds since the time, and set the time to now.
+		double measure(Clock::time_point& time) {
+			Clock::time_point now = Clock::now();
+			double seconds = std::chrono::duration<double>(now - time).count();
+			time = now;
+			return seconds;
+		}
+
+		const int POST_QUEUE_CAPACITY = 4096;
+
+		// Older back buffers are drawn completely.
+		const size_t MAX_BUFFER_AGE = 4;
+
+		// The frame time graph.
+		const float BAR_WIDTH = 2;
+		const float GRAPH_HEIGHT = 50;
+		const double GRAPH_MAX_TIME = 1 / 30.0;
+		const double TARGET_TIME = 1 / 60.0;
+
+	}
+
+	Frame::Frame() : defaultClosing_(false), arena_(std::make_shared<ComponentArena>()), currentPanel_(0),
+		redrawOnDemand_(false), skippedFrames_(0),
+		swapping_(true), releasedWindow_(nullptr), releasedContext_(nullptr),
+		coalesceMouseMotion_(false), pendingMotion_(false), coalescedMotionEvents_(0),
+		dispatchedEvents_(0), dispatchTime_(0), frameDispatchTime_(0),
+		statisticsOverlay_(false), loadBudget_(0.002), drawListEnabled_(false),
+		postQueue_(POST_QUEUE_CAPACITY), postBudget_(0.002) {
 		// Default layout for Frame.
 		addPanelBack();
 
@@ -21,13 +56,12 @@ namespace gui {
 	}
 
 	int Frame::addPanelBack() {
-		auto p = std::make_shared<Panel>();
+		auto p = create<Panel>();
 		p->setLayout<BorderLayout>();
 		return pushBackPanel(p);
 	}
 
 	int Frame::pushBackPanel(const std::shared_ptr<Panel>& panel) {
-		panel->setChildsParent();
 		panels_.push_back(panel);
 		return panels_.size() - 1;
 	}
@@ -60,6 +94,15 @@ namespace gui {
 		}
 	}
 
+	std::vector<std::shared_ptr<Component>> Frame::getFocusPath() const {
+		std::vector<std::shared_ptr<Component>> path;
+		Component* component = getCurrentPanel().get();
+		for (; component != nullptr; component = component->getFocusedChild()) {
+			path.push_back(component->shared_from_this());
+		}
+		return path;
+	}
+
 	mw::signals::Connection Frame::addWindowListener(const WindowListener::Callback& callback) {
 		return windowListener_.connect(callback);
 	}
@@ -76,24 +119,250 @@ namespace gui {
 		return defaultClosing_;
 	}
 
+	void Frame::setRedrawOnDemand(bool redrawOnDemand) {
+		redrawOnDemand_ = redrawOnDemand;
+		getCurrentPanel()->repaint();
+	}
+
+	void Frame::setCoalesceMouseMotion(bool coalesce) {
+		coalesceMouseMotion_ = coalesce;
+		if (!coalesce) {
+			dispatchPendingMotion();
+		}
+	}
+
+	void Frame::setStatisticsOverlay(bool visible) {
+		statisticsOverlay_ = visible;
+		getCurrentPanel()->repaint();
+	}
+
+	void Frame::setStatisticsFont(const mw::Font& font) {
+		statisticsText_ = GlyphText("", font);
+		// Changes every frame.
+		statisticsText_.setCached(false);
+	}
+
 	void Frame::resize(int width, int height) {
 		graphic_.setProj(mw::getOrthoProjectionMatrix44<GLfloat>(0, (GLfloat) width, 0, (GLfloat) height));
+		graphic_.setWindowRect(Rect(0, 0, (float) width, (float) height));
 		getCurrentPanel()->setPreferredSize((float) width, (float) height);
 		getCurrentPanel()->setSize((float) width, (float) height);
 		getCurrentPanel()->setLocation(0, 0);
-		getCurrentPanel()->validate();
+		getCurrentPanel()->invalidate();
 		glViewport(0, 0, width, height);
 	}
 
 	void Frame::update(double deltaTime) {
+		restoreContext();
+		dispatchPendingMotion();
+		double eventsTime = std::chrono::duration<double>(frameDispatchTime_).count();
+		frameDispatchTime_ = Clock::duration(0);
+		graphic_.resetCounters();
+
+		Clock::time_point time = Clock::now();
+		// Hand over the loaded resources before the listeners use them.
+		resourceLoader_.update(loadBudget_);
+		callPosted();
+		double postedTime = measure(time);
+
 		getCurrentPanel()->drawListener(*this, deltaTime);
+		double drawListenersTime = measure(time);
+
+		// Lay out all invalidated components at once.
+		getCurrentPanel()->layout();
+		double layoutTime = measure(time);
+
+		if (drawListEnabled_) {
+			graphic_.beginRecording(drawList_);
+			drawCurrentPanel(deltaTime);
+			graphic_.endRecording(true);
+		} else {
+			drawCurrentPanel(deltaTime);
+		}
+		double drawTime = measure(time);
+
+		statistics_.addTime(FrameStatistics::EVENTS, eventsTime);
+		statistics_.addTime(FrameStatistics::POSTED, postedTime);
+		statistics_.addTime(FrameStatistics::DRAW_LISTENERS, drawListenersTime);
+		statistics_.addTime(FrameStatistics::LAYOUT, layoutTime);
+		statistics_.addTime(FrameStatistics::DRAW, drawTime);
+		statistics_.addTime(FrameStatistics::FRAME, eventsTime + postedTime + drawListenersTime + layoutTime + drawTime);
+		statistics_.addDrawCalls(graphic_.getDrawCalls());
+		statistics_.addTextureBinds(graphic_.getTextureBinds());
+	}
+
+	void Frame::callPosted() {
+		Clock::time_point start = Clock::now();
+		std::function<void()> function;
+		int calls = 0;
+		while (postQueue_.pop(function)) {
+			function();
+			// Reading the clock costs more than a small function.
+			if (++calls % 16 == 0 && std::chrono::duration<double>(Clock::now() - start).count() > postBudget_) {
+				break;
+			}
+		}
+	}
+
+	void Frame::drawCurrentPanel(double deltaTime) {
+		if (!redrawOnDemand_) {
+			getCurrentPanel()->draw(graphic_, deltaTime);
+			drawStatistics();
+			graphic_.flush();
+			return;
+		}
+
+		Rect dirtyRegion;
+		getCurrentPanel()->collectDirtyRegion(dirtyRegion, false);
+		if (statisticsOverlay_) {
+			// The overlay changes every frame.
+			dirtyRegion = dirtyRegion.unite(getStatisticsRect());
+		}
+		if (dirtyRegion.isEmpty()) {
+			// The buffers are not swapped, i.e. the back buffer's age is the same.
+			++skippedFrames_;
+			skipSwap();
+			return;
+		}
+		// The back buffer holds the frame drawn age frames ago, everything
+		// changed since then must be drawn again.
+		int age = getBufferAge();
+		Rect region = dirtyRegion;
+		if (age == 0 || age > (int) dirtyRegions_.size() + 1) {
+			// Unknown content, e.g. copied or undefined after the swap.
+			region = Rect(0, 0, (float) getWidth(), (float) getHeight());
+		} else {
+			for (int i = 0; i < age - 1; ++i) {
+				region = region.unite(dirtyRegions_[i]);
+			}
+		}
+		dirtyRegions_.insert(dirtyRegions_.begin(), dirtyRegion);
+		if (dirtyRegions_.size() > MAX_BUFFER_AGE) {
+			dirtyRegions_.pop_back();
+		}
+
+		graphic_.pushClip(region);
 		getCurrentPanel()->draw(graphic_, deltaTime);
+		drawStatistics();
+		graphic_.popClip();
+		graphic_.flush();
+	}
+
+	void Frame::skipSwap() {
+		if (!swapping_) {
+			return;
+		}
+		// SDL_GL_SwapWindow() does nothing for a window without a current context.
+		releasedWindow_ = SDL_GL_GetCurrentWindow();
+		releasedContext_ = SDL_GL_GetCurrentContext();
+		if (releasedWindow_ != nullptr) {
+			SDL_GL_MakeCurrent(releasedWindow_, nullptr);
+		}
+		SDL_WaitEventTimeout(nullptr, (int) (TARGET_TIME * 1000));
+	}
+
+	void Frame::restoreContext() {
+		if (releasedWindow_ != nullptr) {
+			SDL_GL_MakeCurrent(releasedWindow_, releasedContext_);
+			releasedWindow_ = nullptr;
+			releasedContext_ = nullptr;
+		}
+	}
+
+	Rect Frame::getStatisticsRect() const {
+		float width = statistics_.getTime(FrameStatistics::FRAME).getCapacity() * BAR_WIDTH;
+		float height = GRAPH_HEIGHT;
+		if (statisticsText_.isValid()) {
+			width = std::max(width, statisticsText_.getWidth());
+			height += statisticsText_.getHeight();
+		}
+		return Rect(5, getHeight() - 5 - height, width, height);
+	}
+
+	void Frame::drawStatistics() {
+		if (!statisticsOverlay_) {
+			return;
+		}
+
+		if (statisticsText_.isValid()) {
+			const Samples& frameTimes = statistics_.getTime(FrameStatistics::FRAME);
+			std::stringstream stream;
+			stream << std::fixed << std::setprecision(1)
+				<< frameTimes.getPercentile(0.5) * 1000 << "/"
+				<< frameTimes.getPercentile(0.95) * 1000 << "/"
+				<< frameTimes.getPercentile(0.99) * 1000 << " ms"
+				<< " draws " << statistics_.getDrawCalls().getLast()
+				<< " binds " << statistics_.getTextureBinds().getLast();
+			statisticsText_.setText(stream.str());
+		}
+
+		Rect rect = getStatisticsRect();
+		graphic_.setModel(mw::Matrix44f::I);
+		graphic_.setColor(0, 0, 0, 0.6f);
+		graphic_.drawSquare(rect.x_, rect.y_, rect.width_, rect.height_);
+
+		const Samples& times = statistics_.getTime(FrameStatistics::FRAME);
+		for (int i = 0; i < times.getSize(); ++i) {
+			double time = times[i];
+			if (time > TARGET_TIME) {
+				graphic_.setColor(1, 0.2f, 0.2f);
+			} else {
+				graphic_.setColor(0.2f, 1, 0.2f);
+			}
+			float height = (float) (std::min(time / GRAPH_MAX_TIME, 1.0) * GRAPH_HEIGHT);
+			graphic_.drawSquare(rect.x_ + i * BAR_WIDTH, rect.y_, BAR_WIDTH, height);
+		}
+		graphic_.setColor(1, 1, 1, 0.5f);
+		graphic_.drawSquare(rect.x_, rect.y_ + (float) (TARGET_TIME / GRAPH_MAX_TIME * GRAPH_HEIGHT), rect.width_, 1);
+
+		if (statisticsText_.isValid()) {
+			graphic_.setColor(1, 1, 1);
+			graphic_.drawText(statisticsText_, rect.x_, rect.y_ + GRAPH_HEIGHT);
+		}
 	}
 
 	void Frame::eventUpdate(const SDL_Event& windowEvent) {
+		restoreContext();
+		sdlEventListener_(*this, windowEvent);
+
+		if (coalesceMouseMotion_ && windowEvent.type == SDL_MOUSEMOTION) {
+			if (pendingMotion_ && motionEvent_.motion.windowID == windowEvent.motion.windowID
+				&& motionEvent_.motion.which == windowEvent.motion.which
+				&& motionEvent_.motion.state == windowEvent.motion.state) {
+
+				// Keep the last position and sum the relative motion.
+				Sint32 xrel = motionEvent_.motion.xrel + windowEvent.motion.xrel;
+				Sint32 yrel = motionEvent_.motion.yrel + windowEvent.motion.yrel;
+				motionEvent_ = windowEvent;
+				motionEvent_.motion.xrel = xrel;
+				motionEvent_.motion.yrel = yrel;
+				++coalescedMotionEvents_;
+			} else {
+				dispatchPendingMotion();
+				motionEvent_ = windowEvent;
+				pendingMotion_ = true;
+			}
+			return;
+		}
+
+		// Keep the order of the events.
+		dispatchPendingMotion();
+		dispatchEvent(windowEvent);
+	}
+
+	void Frame::dispatchPendingMotion() {
+		if (pendingMotion_) {
+			pendingMotion_ = false;
+			dispatchEvent(motionEvent_);
+		}
+	}
+
+	void Frame::dispatchEvent(const SDL_Event& windowEvent) {
+		Clock::time_point time = Clock::now();
+		++dispatchedEvents_;
+
 		// Perform non critical event updates.
 		SDL_Event sdlEvent = windowEvent;
-		sdlEventListener_(*this, sdlEvent);
 		switch (sdlEvent.type) {
 			case SDL_WINDOWEVENT:
 				windowListener_(*this, sdlEvent);
@@ -101,6 +370,9 @@ namespace gui {
 					case SDL_WINDOWEVENT_RESIZED:
 						resize(sdlEvent.window.data1, sdlEvent.window.data2);
 						break;
+					case SDL_WINDOWEVENT_EXPOSED:
+						getCurrentPanel()->repaint();
+						break;
 					case SDL_WINDOWEVENT_LEAVE:
 						getCurrentPanel()->mouseMotionLeave();
 						break;
@@ -122,6 +394,9 @@ namespace gui {
 				sdlEvent.button.y = getHeight() - sdlEvent.motion.y;
 				getCurrentPanel()->handleMouse(sdlEvent);
 				break;
+			case SDL_MOUSEWHEEL:
+				getCurrentPanel()->handleMouse(sdlEvent);
+				break;
 			case SDL_TEXTINPUT:
 				// Fall through.
 			case SDL_TEXTEDITING:
@@ -139,10 +414,14 @@ namespace gui {
 				}
 				break;
 		}
+
+		Clock::duration duration = Clock::now() - time;
+		dispatchTime_ += duration;
+		frameDispatchTime_ += duration;
 	}
 
 	void Frame::initPreLoop() {
-		graphic_ = Graphic("gui.ver.glsl", "gui.fra.glsl");
+		graphic_.loadShaders("gui.ver.glsl", "gui.fra.glsl");
 
 		// Initialization the OpenGL settings.
 		resize(getWidth(), getHeight());
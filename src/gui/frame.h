@@ -4,15 +4,23 @@
 #include "panel.h"
 #include "layoutmanager.h"
 #include "graphic.h"
+#include "framestatistics.h"
+#include "glyphtext.h"
+#include "resourceloader.h"
+#include "componentarena.h"
+#include "mpscqueue.h"
 
 #include <mw/window.h>
 #include <mw/color.h>
 #include <mw/signal.h>
+#include <mw/font.h>
 
 #include <SDL.h>
 
 #include <string>
 #include <queue>
+#include <chrono>
+#include <functional>
 
 namespace gui {
 
@@ -23,6 +31,8 @@ namespace gui {
 
 	class Frame : public mw::Window {
 	public:
+		friend class Headless;
+
 		using iterator = std::vector<std::shared_ptr<Panel>>::iterator;
 		using const_iterator = std::vector<std::shared_ptr<Panel>>::const_iterator;
 
@@ -37,6 +47,16 @@ namespace gui {
 		// The panel index is returned.
 		int pushBackPanel(const std::shared_ptr<Panel>& panel);
 
+		// Create a component in the frame's arena, i.e. placed next to the
+		// other components created by the frame. The templated add functions
+		// create the components the same way.
+		template <class Comp, class... Args>
+		std::shared_ptr<Comp> create(Args&&... args);
+
+		const std::shared_ptr<ComponentArena>& getArena() const {
+			return arena_;
+		}
+
         // Add the component, with the provided layoutIndex.
 		// Will assert if the component already added.
 		template <class Comp, class... Args>
@@ -98,6 +118,10 @@ namespace gui {
 
 		std::shared_ptr<Panel> getCurrentPanel() const;
 
+		// Return the components receiving the keyboard events, from the
+		// current panel down to the focused component.
+		std::vector<std::shared_ptr<Component>> getFocusPath() const;
+
 		// Add a key listener to the current panel.
 		mw::signals::Connection addKeyListener(const KeyListener::Callback& callback);
 
@@ -116,6 +140,115 @@ namespace gui {
 		// Add a update listener to the current panel.
 		mw::signals::Connection addDrawListener(const DrawListener::Callback& callback);
 
+		// Skip the frame if nothing changed, i.e. nothing is drawn and the
+		// buffers are not swapped. Instead of the swap's vsync, the loop waits
+		// for a event at most one frame. Else only redraw the parts of the
+		// window changed since the back buffer was drawn. The back buffer's
+		// age is only known with EGL_EXT_buffer_age or GLX_EXT_buffer_age,
+		// else the whole window is drawn. Default is false.
+		void setRedrawOnDemand(bool redrawOnDemand);
+
+		bool isRedrawOnDemand() const;
+
+		// Return the number of frames skipped because nothing changed.
+		int getSkippedFrames() const;
+
+		// Panels unchanged for this number of frames are drawn to a cached
+		// texture, see Panel::setCached(). Zero turns the automatic caching off.
+		void setPanelCacheThreshold(int frames);
+
+		int getPanelCacheThreshold() const;
+
+		// Merge the mouse motion events received during one frame into one event,
+		// before sending it to the components. The relative motion is summed and
+		// the last position is kept. Listeners added by addSdlEventListener()
+		// still receive every event. Default is false.
+		void setCoalesceMouseMotion(bool coalesce);
+
+		bool isCoalesceMouseMotion() const;
+
+		// Return the number of mouse motion events merged into another event.
+		int getCoalescedMotionEvents() const;
+
+		// Return the number of events sent to the components.
+		int getDispatchedEvents() const;
+
+		// Return the total time in seconds spent sending events to the components.
+		double getDispatchTime() const;
+
+		// Return the measurements of the last frames.
+		const FrameStatistics& getStatistics() const {
+			return statistics_;
+		}
+
+		// Return the number of shader program binds and uniform uploads,
+		// issued and skipped, in the last frame.
+		const GuiShader::Counters& getShaderCounters() const {
+			return graphic_.getShaderCounters();
+		}
+
+		// Show a graph of the last frame times in the upper left corner of the
+		// window. Default is false.
+		void setStatisticsOverlay(bool visible);
+
+		bool isStatisticsOverlay() const {
+			return statisticsOverlay_;
+		}
+
+		// Set the font used to show the frame time percentiles, draw call
+		// and texture bind counts in the overlay. No text is shown without a font.
+		void setStatisticsFont(const mw::Font& font);
+
+		// Record each frame to a draw list, ordered by texture, before drawing
+		// it. Cached panels are drawn directly while recording. Default is false.
+		void setDrawListEnabled(bool enabled) {
+			drawListEnabled_ = enabled;
+		}
+
+		bool isDrawListEnabled() const {
+			return drawListEnabled_;
+		}
+
+		// Return the draw list of the last recorded frame.
+		const DrawList& getDrawList() const {
+			return drawList_;
+		}
+
+		// Call the function on the gui thread at the start of a frame, before
+		// the draw listeners. Safe to call from any thread, e.g. to update
+		// widgets from worker threads. Return false if the queue is full,
+		// i.e. the gui thread is behind.
+		bool post(std::function<void()> function) {
+			return postQueue_.push(std::move(function));
+		}
+
+		// Set the maximum time in seconds spent each frame calling the posted
+		// functions, the rest waits for the next frame. Default is 0.002.
+		void setPostBudget(double seconds) {
+			postBudget_ = seconds;
+		}
+
+		double getPostBudget() const {
+			return postBudget_;
+		}
+
+		// Return the loader used to load sprites and fonts in the background.
+		// The loaded resources are handed to the callbacks at the start of
+		// each frame, see setLoadBudget().
+		ResourceLoader& getResourceLoader() {
+			return resourceLoader_;
+		}
+
+		// Set the maximum time in seconds spent each frame creating the
+		// loaded textures and fonts. Default is 0.002.
+		void setLoadBudget(double seconds) {
+			loadBudget_ = seconds;
+		}
+
+		double getLoadBudget() const {
+			return loadBudget_;
+		}
+
 	protected:
 		// Override mw::Window.
 		virtual void initPreLoop() override;
@@ -129,20 +262,77 @@ namespace gui {
 	private:
 		void resize(int width, int height);
 
+		// Send the event to the current panel.
+		void dispatchEvent(const SDL_Event& windowEvent);
+
+		// Send the merged mouse motion event, if any.
+		void dispatchPendingMotion();
+
+		void drawCurrentPanel(double deltaTime);
+
+		// Call the posted functions, until the time budget is used.
+		void callPosted();
+
+		// Return the overlay's rectangle in window coordinates.
+		Rect getStatisticsRect() const;
+
+		void drawStatistics();
+
+		// Keep mw::Window from swapping the buffers after update(), by
+		// releasing the context until the next event or update.
+		void skipSwap();
+
+		void restoreContext();
+
 		WindowListener windowListener_;
 		SdlEventListener sdlEventListener_;
 		Graphic graphic_;
 
 		bool defaultClosing_;
+		// Before the panels, i.e. destroyed after the components.
+		std::shared_ptr<ComponentArena> arena_;
 		std::vector<std::shared_ptr<Panel>> panels_;
 		int currentPanel_;
+
+		bool redrawOnDemand_;
+		int skippedFrames_;
+		std::vector<Rect> dirtyRegions_; // Of the last drawn frames, the latest first.
+		bool swapping_; // The window swaps the buffers after update(), false if Headless.
+		SDL_Window* releasedWindow_; // Not null if the context is released by a skipped frame.
+		SDL_GLContext releasedContext_;
+
+		bool coalesceMouseMotion_;
+		bool pendingMotion_;
+		SDL_Event motionEvent_;
+		int coalescedMotionEvents_;
+		int dispatchedEvents_;
+		std::chrono::high_resolution_clock::duration dispatchTime_;
+		std::chrono::high_resolution_clock::duration frameDispatchTime_; // Since the last frame.
+
+		FrameStatistics statistics_;
+		bool statisticsOverlay_;
+		GlyphText statisticsText_;
+
+		ResourceLoader resourceLoader_;
+		double loadBudget_;
+
+		bool drawListEnabled_;
+		DrawList drawList_;
+
+		MpscQueue<std::function<void()>> postQueue_;
+		double postBudget_;
 	};
 
+	template <class Comp, class... Args>
+	std::shared_ptr<Comp> Frame::create(Args&&... args) {
+		return std::allocate_shared<Comp>(ArenaAllocator<Comp>(arena_), std::forward<Args>(args)...);
+	}
+
 	// Add the component, with the provided layoutIndex.
 	// Will assert if the component already added.
 	template <class Comp, class... Args>
 	std::shared_ptr<Comp> Frame::addDefault(Args... args) {
-		auto c = std::make_shared<Comp>(args...);
+		auto c = create<Comp>(args...);
 		add(DEFAULT_INDEX, c);
 		return c;
 	}
@@ -151,7 +341,7 @@ namespace gui {
 	// Will assert if the component already added.
 	template <class Comp, class... Args>
 	std::shared_ptr<Comp> Frame::add(int layoutIndex, Args... args) {
-		auto c = std::make_shared<Comp>(args...);
+		auto c = create<Comp>(args...);
 		add(layoutIndex, c);
 		return c;
 	}
@@ -171,6 +361,38 @@ namespace gui {
 		return currentPanel_;
 	}
 
+	inline bool Frame::isRedrawOnDemand() const {
+		return redrawOnDemand_;
+	}
+
+	inline int Frame::getSkippedFrames() const {
+		return skippedFrames_;
+	}
+
+	inline void Frame::setPanelCacheThreshold(int frames) {
+		graphic_.setCacheThreshold(frames);
+	}
+
+	inline int Frame::getPanelCacheThreshold() const {
+		return graphic_.getCacheThreshold();
+	}
+
+
+	inline bool Frame::isCoalesceMouseMotion() const {
+		return coalesceMouseMotion_;
+	}
+
+	inline int Frame::getCoalescedMotionEvents() const {
+		return coalescedMotionEvents_;
+	}
+
+	inline int Frame::getDispatchedEvents() const {
+		return dispatchedEvents_;
+	}
+
+	inline double Frame::getDispatchTime() const {
+		return std::chrono::duration<double>(dispatchTime_).count();
+	}
 
 	inline std::shared_ptr<Panel> Frame::getCurrentPanel() const {
 		return panels_[currentPanel_];
@@ -0,0 +1,75 @@
+#include "framestatistics.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace gui {
+
+	Samples::Samples(int capacity) : values_(capacity), next_(0), size_(0) {
+		assert(capacity > 0);
+	}
+
+	void Samples::add(double value) {
+		values_[next_] = value;
+		next_ = (next_ + 1) % values_.size();
+		size_ = std::min(size_ + 1, (int) values_.size());
+	}
+
+	void Samples::clear() {
+		next_ = 0;
+		size_ = 0;
+	}
+
+	double Samples::getPercentile(double fraction) const {
+		if (size_ == 0) {
+			return 0;
+		}
+		sorted_.clear();
+		for (int i = 0; i < size_; ++i) {
+			sorted_.push_back((*this)[i]);
+		}
+		int index = std::min(size_ - 1, std::max(0, (int) std::ceil(fraction * size_) - 1));
+		std::nth_element(sorted_.begin(), sorted_.begin() + index, sorted_.end());
+		return sorted_[index];
+	}
+
+	double Samples::getAverage() const {
+		if (size_ == 0) {
+			return 0;
+		}
+		double sum = 0;
+		for (int i = 0; i < size_; ++i) {
+			sum += (*this)[i];
+		}
+		return sum / size_;
+	}
+
+	double Samples::getMax() const {
+		double max = 0;
+		for (int i = 0; i < size_; ++i) {
+			max = std::max(max, (*this)[i]);
+		}
+		return max;
+	}
+
+	double Samples::getLast() const {
+		if (size_ == 0) {
+			return 0;
+		}
+		return (*this)[size_ - 1];
+	}
+
+	FrameStatistics::FrameStatistics(int capacity) : times_(PHASES, Samples(capacity)),
+		drawCalls_(capacity), textureBinds_(capacity) {
+	}
+
+	void FrameStatistics::clear() {
+		for (auto& samples : times_) {
+			samples.clear();
+		}
+		drawCalls_.clear();
+		textureBinds_.clear();
+	}
+
+} // Namespace gui.
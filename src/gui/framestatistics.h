@@ -0,0 +1,100 @@
+#ifndef GUI_FRAMESTATISTICS_H
+#define GUI_FRAMESTATISTICS_H
+
+#include <vector>
+
+namespace gui {
+
+	// The last added values, kept in a ring buffer.
+	class Samples {
+	public:
+		explicit Samples(int capacity = 128);
+
+		void add(double value);
+
+		void clear();
+
+		// Return the value which the fraction of the values are less than
+		// or equal to. The fraction is in the range [0, 1]. Return 0 if empty.
+		double getPercentile(double fraction) const;
+
+		double getAverage() const;
+
+		double getMax() const;
+
+		// Return the last added value. Return 0 if empty.
+		double getLast() const;
+
+		int getSize() const {
+			return size_;
+		}
+
+		int getCapacity() const {
+			return (int) values_.size();
+		}
+
+		// Return the value with the index, the oldest value has index 0.
+		double operator[](int index) const {
+			int capacity = (int) values_.size();
+			return values_[(next_ - size_ + index + capacity) % capacity];
+		}
+
+	private:
+		std::vector<double> values_;
+		mutable std::vector<double> sorted_;
+		int next_;
+		int size_;
+	};
+
+	// Measurements of the last frames. Times are in seconds.
+	class FrameStatistics {
+	public:
+		enum Phase {
+			EVENTS,			// Events sent to the components.
+			POSTED,			// Loaded resources handed over and posted functions.
+			DRAW_LISTENERS,	// Draw listener callbacks.
+			LAYOUT,			// Layout of invalidated components.
+			DRAW,			// Drawing of the current panel.
+			FRAME,			// All phases.
+			PHASES
+		};
+
+		explicit FrameStatistics(int capacity = 128);
+
+		const Samples& getTime(Phase phase) const {
+			return times_[phase];
+		}
+
+		// Return the number of OpenGL draw calls for each frame.
+		const Samples& getDrawCalls() const {
+			return drawCalls_;
+		}
+
+		// Return the number of texture binds for each frame.
+		const Samples& getTextureBinds() const {
+			return textureBinds_;
+		}
+
+		void addTime(Phase phase, double time) {
+			times_[phase].add(time);
+		}
+
+		void addDrawCalls(int drawCalls) {
+			drawCalls_.add(drawCalls);
+		}
+
+		void addTextureBinds(int textureBinds) {
+			textureBinds_.add(textureBinds);
+		}
+
+		void clear();
+
+	private:
+		std::vector<Samples> times_;
+		Samples drawCalls_;
+		Samples textureBinds_;
+	};
+
+} // Namespace gui.
+
+#endif // GUI_FRAMESTATISTICS_H
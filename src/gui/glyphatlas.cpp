@@ -0,0 +1,219 @@
+#include "glyphatlas.h"
+
+#include <SDL_ttf.h>
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+
+namespace gui {
+
+	namespace {
+
+		const int ATLAS_WIDTH = 512;
+		const int ATLAS_START_HEIGHT = 128;
+		const int ATLAS_MAX_HEIGHT = 4096;
+		const int PADDING = 1;
+
+		// Encode a unicode character in the basic multilingual plane as utf8.
+		int encodeUtf8(Uint16 character, char* utf8) {
+			if (character < 0x80) {
+				utf8[0] = (char) character;
+				utf8[1] = 0;
+				return 1;
+			} else if (character < 0x800) {
+				utf8[0] = (char) (0xC0 | (character >> 6));
+				utf8[1] = (char) (0x80 | (character & 0x3F));
+				utf8[2] = 0;
+				return 2;
+			}
+			utf8[0] = (char) (0xE0 | (character >> 12));
+			utf8[1] = (char) (0x80 | ((character >> 6) & 0x3F));
+			utf8[2] = (char) (0x80 | (character & 0x3F));
+			utf8[3] = 0;
+			return 3;
+		}
+
+	}
+
+	Uint16 decodeUtf8(const std::string& text, size_t& index) {
+		unsigned char token = text[index];
+		int length = 1;
+		Uint32 character = token;
+		if (token >= 0xF0) {
+			length = 4;
+			character = token & 0x07;
+		} else if (token >= 0xE0) {
+			length = 3;
+			character = token & 0x0F;
+		} else if (token >= 0xC0) {
+			length = 2;
+			character = token & 0x1F;
+		}
+		for (int i = 1; i < length && index + i < text.size(); ++i) {
+			character = (character << 6) | (text[index + i] & 0x3F);
+		}
+		index += length;
+		return character > 0xFFFF ? '?' : (Uint16) character;
+	}
+
+	std::shared_ptr<GlyphAtlas> GlyphAtlas::get(const mw::Font& font) {
+		static std::map<TTF_Font*, std::weak_ptr<GlyphAtlas>> atlases;
+
+		TTF_Font* ttfFont = font.getTtfFont();
+		if (ttfFont == nullptr) {
+			return nullptr;
+		}
+
+		// The font of a released atlas may be freed, and its pointer reused by a new font.
+		for (auto it = atlases.begin(); it != atlases.end();) {
+			if (it->second.expired()) {
+				it = atlases.erase(it);
+			} else {
+				++it;
+			}
+		}
+
+		auto& weakAtlas = atlases[ttfFont];
+		auto atlas = weakAtlas.lock();
+		if (atlas == nullptr) {
+			atlas = std::make_shared<GlyphAtlas>(font);
+			weakAtlas = atlas;
+		}
+		return atlas;
+	}
+
+	GlyphAtlas::GlyphAtlas(const mw::Font& font) : font_(font),
+		width_(ATLAS_WIDTH), height_(ATLAS_START_HEIGHT),
+		shelfX_(0), shelfY_(0), shelfHeight_(0),
+		lineHeight_((float) TTF_FontHeight(font.getTtfFont())),
+		full_(false),
+		texture_(0), textureHeight_(0),
+		dirtyMinY_(0), dirtyMaxY_(0) {
+
+		pixels_.resize(width_ * height_ * 4, 0);
+	}
+
+	GlyphAtlas::~GlyphAtlas() {
+		if (texture_ != 0) {
+			glDeleteTextures(1, &texture_);
+		}
+	}
+
+	const Glyph& GlyphAtlas::getGlyph(Uint16 character) {
+		auto it = glyphs_.find(character);
+		if (it == glyphs_.end()) {
+			it = glyphs_.emplace(character, rasterize(character)).first;
+		}
+		return it->second;
+	}
+
+	GLuint GlyphAtlas::bindTexture() {
+		if (texture_ == 0) {
+			glGenTextures(1, &texture_);
+			glBindTexture(GL_TEXTURE_2D, texture_);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		} else {
+			glBindTexture(GL_TEXTURE_2D, texture_);
+		}
+
+		if (textureHeight_ != height_) {
+			// Upload the whole atlas.
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width_, height_, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels_.data());
+			textureHeight_ = height_;
+		} else if (dirtyMinY_ < dirtyMaxY_) {
+			// Upload only the rows with new glyphs.
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, dirtyMinY_, width_, dirtyMaxY_ - dirtyMinY_,
+				GL_RGBA, GL_UNSIGNED_BYTE, pixels_.data() + dirtyMinY_ * width_ * 4);
+		}
+		dirtyMinY_ = 0;
+		dirtyMaxY_ = 0;
+		return texture_;
+	}
+
+	Glyph GlyphAtlas::rasterize(Uint16 character) {
+		TTF_Font* ttfFont = font_.getTtfFont();
+		Glyph glyph{0, 0, 0, 0, 0, TTF_GlyphIsProvided(ttfFont, character) != 0};
+
+		int minX, maxX, minY, maxY, advance;
+		if (TTF_GlyphMetrics(ttfFont, character, &minX, &maxX, &minY, &maxY, &advance) == 0) {
+			glyph.advance_ = (float) advance;
+		}
+
+		char utf8[4];
+		encodeUtf8(character, utf8);
+		SDL_Surface* surface = TTF_RenderUTF8_Blended(ttfFont, utf8, SDL_Color{255, 255, 255, 255});
+		if (surface == nullptr) {
+			return glyph;
+		}
+
+		int x, y;
+		if (insert(surface->w, surface->h, x, y)) {
+			SDL_LockSurface(surface);
+			const SDL_PixelFormat* format = surface->format;
+			for (int row = 0; row < surface->h; ++row) {
+				// The surface starts with the top row, the atlas with the bottom row.
+				const Uint32* src = (const Uint32*) ((const Uint8*) surface->pixels + row * surface->pitch);
+				Uint8* dst = pixels_.data() + ((y + surface->h - 1 - row) * width_ + x) * 4;
+				for (int column = 0; column < surface->w; ++column) {
+					dst[0] = 255;
+					dst[1] = 255;
+					dst[2] = 255;
+					dst[3] = (Uint8) ((src[column] & format->Amask) >> format->Ashift);
+					dst += 4;
+				}
+			}
+			SDL_UnlockSurface(surface);
+
+			glyph.x_ = (float) x;
+			glyph.y_ = (float) y;
+			glyph.width_ = (float) surface->w;
+			glyph.height_ = (float) surface->h;
+			if (dirtyMinY_ < dirtyMaxY_) {
+				dirtyMinY_ = std::min(dirtyMinY_, y);
+				dirtyMaxY_ = std::max(dirtyMaxY_, y + surface->h);
+			} else {
+				dirtyMinY_ = y;
+				dirtyMaxY_ = y + surface->h;
+			}
+		}
+		SDL_FreeSurface(surface);
+		return glyph;
+	}
+
+	bool GlyphAtlas::insert(int width, int height, int& x, int& y) {
+		if (width + PADDING > width_) {
+			return false;
+		}
+
+		// New shelf?
+		if (shelfX_ + width + PADDING > width_) {
+			shelfY_ += shelfHeight_;
+			shelfX_ = 0;
+			shelfHeight_ = 0;
+		}
+
+		// Grow the atlas.
+		while (shelfY_ + height + PADDING > height_) {
+			if (height_ * 2 > ATLAS_MAX_HEIGHT) {
+				if (!full_) {
+					full_ = true;
+					std::cerr << "GlyphAtlas is full, new glyphs of the font are not drawn\n";
+				}
+				return false;
+			}
+			height_ *= 2;
+			pixels_.resize(width_ * height_ * 4, 0);
+		}
+
+		x = shelfX_;
+		y = shelfY_;
+		shelfX_ += width + PADDING;
+		shelfHeight_ = std::max(shelfHeight_, height + PADDING);
+		return true;
+	}
+
+} // Namespace gui.
@@ -0,0 +1,96 @@
+#ifndef GUI_GLYPHATLAS_H
+#define GUI_GLYPHATLAS_H
+
+#include <mw/opengl.h>
+#include <mw/font.h>
+
+#include <SDL.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gui {
+
+	// A rasterized glyph. The position and size is in pixels inside the atlas.
+	struct Glyph {
+		float x_, y_;
+		float width_, height_;
+		float advance_;
+		bool provided_;
+	};
+
+	// Decode the utf8 character at the index and move the index to the next character.
+	// Characters outside the basic multilingual plane are returned as '?'.
+	Uint16 decodeUtf8(const std::string& text, size_t& index);
+
+	// Rasterizes each glyph of a font once into a texture shared by all
+	// text using the font. The texture grows in height when full. At the
+	// maximum height new glyphs only get an advance and are not drawn, which
+	// is reported once on std::cerr.
+	class GlyphAtlas {
+	public:
+		// Return the atlas for the font. All calls with the same font
+		// return the same atlas as long as it is used.
+		static std::shared_ptr<GlyphAtlas> get(const mw::Font& font);
+
+		GlyphAtlas(const mw::Font& font);
+
+		~GlyphAtlas();
+
+		GlyphAtlas(const GlyphAtlas&) = delete;
+		GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+
+		// Return the glyph for the unicode character. The glyph is
+		// rasterized the first time it is requested.
+		const Glyph& getGlyph(Uint16 character);
+
+		// Bind the atlas texture and return its id. New glyphs
+		// are uploaded to the graphic card.
+		GLuint bindTexture();
+
+		int getWidth() const {
+			return width_;
+		}
+
+		int getHeight() const {
+			return height_;
+		}
+
+		// Return the height of a line of text.
+		float getLineHeight() const {
+			return lineHeight_;
+		}
+
+		const mw::Font& getFont() const {
+			return font_;
+		}
+
+		// Return true if a glyph did not fit in the texture.
+		bool isFull() const {
+			return full_;
+		}
+
+	private:
+		Glyph rasterize(Uint16 character);
+
+		// Return the atlas position for a image of the given size.
+		bool insert(int width, int height, int& x, int& y);
+
+		mw::Font font_;
+		std::unordered_map<Uint16, Glyph> glyphs_;
+		std::vector<Uint8> pixels_; // RGBA, first row is the bottom row.
+		int width_, height_;
+		int shelfX_, shelfY_, shelfHeight_;
+		float lineHeight_;
+		bool full_;
+
+		GLuint texture_;
+		int textureHeight_;
+		int dirtyMinY_, dirtyMaxY_;
+	};
+
+} // Namespace gui.
+
+#endif // GUI_GLYPHATLAS_H
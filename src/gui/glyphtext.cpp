@@ -0,0 +1,112 @@
+#include "glyphtext.h"
+
+#include <algorithm>
+
+namespace gui {
+
+	namespace {
+
+		// Return true if the quad's character starts before the byte index.
+		bool isBefore(const GlyphQuad& quad, int index) {
+			return quad.index_ < index;
+		}
+
+	}
+
+	GlyphText::GlyphText() : characterSize_(0), cached_(true) {
+	}
+
+	GlyphText::GlyphText(std::string text, const mw::Font& font) : text_(text),
+		atlas_(GlyphAtlas::get(font)), characterSize_((float) font.getCharacterSize()), cached_(true) {
+
+		layout();
+	}
+
+	GlyphText::GlyphText(const mw::Text& text) : text_(text.getText()),
+		prerendered_(std::make_shared<mw::Text>(text)), characterSize_(text.getCharacterSize()), cached_(true) {
+	}
+
+	void GlyphText::setText(std::string_view text) {
+		if (text_ != text) {
+			text_.assign(text.data(), text.size());
+			layout();
+		}
+	}
+
+	void GlyphText::replace(int position, int size, std::string_view text) {
+		if (cached_ || atlas_ == nullptr || run_ == nullptr) {
+			text_.replace(position, size, text.data(), text.size());
+			layout();
+			return;
+		}
+
+		float x = getOffset(position);
+		float removedWidth = 0;
+		size_t index = position;
+		while (index < (size_t) (position + size)) {
+			removedWidth += atlas_->getGlyph(decodeUtf8(text_, index)).advance_;
+		}
+		std::shared_ptr<const GlyphRun> insertedRun = TextCache::layout(*atlas_, std::string(text));
+
+		// Copied if shared, e.g. by a copy of the text.
+		std::shared_ptr<GlyphRun> run = run_.use_count() == 1
+			? std::const_pointer_cast<GlyphRun>(run_) : std::make_shared<GlyphRun>(*run_);
+		std::vector<GlyphQuad>& quads = run->quads_;
+		int first = (int) (std::lower_bound(quads.begin(), quads.end(), position, isBefore) - quads.begin());
+		int last = (int) (std::lower_bound(quads.begin() + first, quads.end(), position + size, isBefore) - quads.begin());
+
+		float delta = insertedRun->width_ - removedWidth;
+		int shift = (int) text.size() - size;
+		for (int i = last; i < (int) quads.size(); ++i) {
+			quads[i].x_ += delta;
+			quads[i].index_ += shift;
+		}
+		quads.erase(quads.begin() + first, quads.begin() + last);
+		quads.insert(quads.begin() + first, insertedRun->quads_.begin(), insertedRun->quads_.end());
+		for (int i = first; i < first + (int) insertedRun->quads_.size(); ++i) {
+			quads[i].x_ += x;
+			quads[i].index_ += position;
+		}
+
+		text_.replace(position, size, text.data(), text.size());
+		run->width_ = text_.empty() ? 0 : run->width_ + delta;
+		run->height_ = text_.empty() ? 0 : atlas_->getLineHeight();
+		run_ = run;
+	}
+
+	float GlyphText::getOffset(int position) const {
+		// Start at the last quad before, only the characters without a quad
+		// in between, e.g. spaces, are summed.
+		const std::vector<GlyphQuad>& quads = run_->quads_;
+		auto it = std::lower_bound(quads.begin(), quads.end(), position, isBefore);
+		float x = 0;
+		size_t index = 0;
+		if (it != quads.begin()) {
+			x = (it - 1)->x_;
+			index = (it - 1)->index_;
+		}
+		while (index < (size_t) position) {
+			x += atlas_->getGlyph(decodeUtf8(text_, index)).advance_;
+		}
+		return x;
+	}
+
+	void GlyphText::layout() {
+		if (prerendered_ != nullptr) {
+			if (prerendered_.use_count() > 1) {
+				prerendered_ = std::make_shared<mw::Text>(*prerendered_);
+			}
+			prerendered_->setText(text_);
+			return;
+		}
+		if (atlas_ == nullptr) {
+			return;
+		}
+		if (cached_) {
+			run_ = TextCache::getInstance().get(atlas_, text_);
+		} else {
+			run_ = TextCache::layout(*atlas_, text_);
+		}
+	}
+
+} // Namespace gui.
@@ -0,0 +1,109 @@
+#ifndef GUI_GLYPHTEXT_H
+#define GUI_GLYPHTEXT_H
+
+#include "glyphatlas.h"
+#include "textcache.h"
+
+#include <mw/font.h>
+#include <mw/text.h>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace gui {
+
+	// A utf8 string laid out as quads referencing the glyph atlas of the font.
+	// Changing the text only lays out the quads again, already rasterized
+	// glyphs are reused. Equal texts share the quads through the TextCache.
+	class GlyphText {
+	public:
+		GlyphText();
+
+		GlyphText(std::string text, const mw::Font& font);
+
+		// Draw the text rendered by SDL_ttf instead of using the glyph atlas,
+		// e.g. text made by existing code. Changing the text renders it again.
+		explicit GlyphText(const mw::Text& text);
+
+		// The string's memory is reused when the text changes.
+		void setText(std::string_view text);
+
+		// Replace the size bytes at the position with the text. When not
+		// cached, only the new characters are laid out and the quads after
+		// them are moved.
+		void replace(int position, int size, std::string_view text);
+
+		// Share the laid out text through the TextCache. Turn it off for
+		// text changing often, e.g. edited text and counters, to not fill the
+		// cache with strings used once. Default is true.
+		void setCached(bool cached) {
+			cached_ = cached;
+		}
+
+		bool isCached() const {
+			return cached_;
+		}
+
+		const std::string& getText() const {
+			return text_;
+		}
+
+		float getWidth() const {
+			if (prerendered_ != nullptr) {
+				return prerendered_->getWidth();
+			}
+			return run_ != nullptr ? run_->width_ : 0;
+		}
+
+		float getHeight() const {
+			if (prerendered_ != nullptr) {
+				return prerendered_->getHeight();
+			}
+			return run_ != nullptr ? run_->height_ : 0;
+		}
+
+		float getCharacterSize() const {
+			return characterSize_;
+		}
+
+		// Return true if there is something to draw.
+		bool isValid() const {
+			if (prerendered_ != nullptr) {
+				return prerendered_->isValid();
+			}
+			return run_ != nullptr && !run_->quads_.empty();
+		}
+
+		// Return the text rendered by SDL_ttf, or null if the glyph atlas is used.
+		const mw::Text* getPrerendered() const {
+			return prerendered_.get();
+		}
+
+		// Must only be called when valid and not prerendered.
+		const std::vector<GlyphQuad>& getQuads() const {
+			return run_->quads_;
+		}
+
+		const std::shared_ptr<GlyphAtlas>& getAtlas() const {
+			return atlas_;
+		}
+
+	private:
+		void layout();
+
+		// Return the x position of the character at the byte position.
+		float getOffset(int position) const;
+
+		std::string text_;
+		std::shared_ptr<GlyphAtlas> atlas_;
+		std::shared_ptr<const GlyphRun> run_;
+		std::shared_ptr<mw::Text> prerendered_; // Shared by the copies until changed.
+		float characterSize_;
+		bool cached_;
+	};
+
+} // Namespace gui.
+
+#endif // GUI_GLYPHTEXT_H
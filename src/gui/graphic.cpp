@@ -1,34 +1,47 @@
 #include "graphic.h"
 
-#include <mw/buffer.h>
-
-#include <array>
+#include <cassert>
+#include <cmath>
 
 namespace gui {
 
-	Graphic::Graphic() {
+	namespace {
+
+		// Used until the window's size is known.
+		const Rect UNBOUNDED(-1e30f, -1e30f, 2e30f, 2e30f);
+
+		// Return the texture bound by the last call to bindTexture().
+		GLuint getBoundTexture() {
+			GLint texture = 0;
+			glGetIntegerv(GL_TEXTURE_BINDING_2D, &texture);
+			return (GLuint) texture;
+		}
+
 	}
 
-	Graphic::Graphic(std::string vShaderFile, std::string fShaderFile) {
-		guiShader_ = GuiShader(vShaderFile, fShaderFile);
+	Graphic::Graphic() : windowRect_(UNBOUNDED), model_(mw::Matrix44f::I),
+		batching_(true), cacheThreshold_(0), drawList_(nullptr) {
+	}
+
+	Graphic::Graphic(std::string vShaderFile, std::string fShaderFile) : 
+		windowRect_(UNBOUNDED), model_(mw::Matrix44f::I),
+		batching_(true), cacheThreshold_(0), drawList_(nullptr) {
+
+		loadShaders(vShaderFile, fShaderFile);
+	}
 
-		guiVertexData_ = std::make_shared<GuiVertexData>(guiShader_);
-		guiVertexData_->begin();
-		guiVertexData_->addSquareTRIANGLE_STRIP(0, 0, 1, 1);
-		guiVertexData_->end();
-		
-		mw::Buffer buffer(mw::Buffer::STATIC);
-		buffer.addVertexData(guiVertexData_);
-		buffer.uploadToGraphicCard();
+	void Graphic::loadShaders(std::string vShaderFile, std::string fShaderFile) {
+		guiShader_ = GuiShader(vShaderFile, fShaderFile);
+		batch_ = std::make_shared<GuiBatch>(guiShader_);
+		setModel(model_);
 	}
 
-	// Uniforms. -------------------------------------------
 	void Graphic::setColor(const mw::Color& color) const {
-		guiShader_.setUColor(color);
+		color_ = color;
 	}
 
 	void Graphic::setColor(float red, float green, float blue, float alpha) const {
-		guiShader_.setUColor(mw::Color(red, green, blue, alpha));
+		color_ = mw::Color(red, green, blue, alpha);
 	}
 
 	void Graphic::drawBorder(float x, float y, float w, float h) const {
@@ -43,81 +56,282 @@ namespace gui {
 	}
 
 	void Graphic::drawSquare(float x, float y, float w, float h) const {
-		mw::Matrix44f uPos = mw::Matrix44f::I;
-		mw::translate2D(uPos, x, y);
-		mw::scale2D(uPos, w, h);
-		guiShader_.setUPos(uPos);
-
-		// Use as non texture!
-		guiShader_.setUIsTex(false);
-		draw();
+		addQuad(x, y, w, h);
 	}
 
 	void Graphic::drawSprite(const mw::Sprite& sprite, float x, float y, float w, float h) const {
 		const mw::Texture& texture = sprite.getTexture();
 		if (texture.isValid()) {
-			guiShader_.useProgram();
 			texture.bindTexture();
+			addSprite(sprite, getBoundTexture(), x, y, w, h);
+		}
+	}
 
-			mw::Matrix44f uPos(
-				w, 0, 0, x,
-				0, h, 0, y,
-				0, 0, 1, 0,
-				0, 0, 0, 1
-			);
-			guiShader_.setUPos(uPos);
-
-			mw::Matrix44f uTex(
-				sprite.getWidth() / texture.getWidth(), 0, 0, sprite.getX() / texture.getWidth(),
-				0, sprite.getHeight() / texture.getHeight(), 0, sprite.getY() / texture.getHeight(),
-				0, 0, 1, 0,
-				0, 0, 0, 1
-			);
-			guiShader_.setUTex(uTex);
-
-			// Use as texture!
-			guiShader_.setUIsTex(true);
-			draw();
+	void Graphic::drawSprite(const BoundSprite& sprite, float x, float y, float w, float h) const {
+		const mw::Texture& texture = sprite.sprite_.getTexture();
+		if (texture.isValid()) {
+			if (sprite.textureId_ == 0) {
+				// Uploads the texture the first time, then only read once.
+				texture.bindTexture();
+				sprite.textureId_ = getBoundTexture();
+			}
+			addSprite(sprite.sprite_, sprite.textureId_, x, y, w, h);
 		}
 	}
 
+	void Graphic::addSprite(const mw::Sprite& sprite, GLuint texture, float x, float y, float w, float h) const {
+		const mw::Texture& spriteTexture = sprite.getTexture();
+		float texW = (float) spriteTexture.getWidth();
+		float texH = (float) spriteTexture.getHeight();
+		addQuad(x, y, w, h,
+			sprite.getX() / texW, sprite.getY() / texH,
+			(sprite.getX() + sprite.getWidth()) / texW, (sprite.getY() + sprite.getHeight()) / texH,
+			texture);
+	}
+
 	void Graphic::drawText(const mw::Text& text, float x, float y) const {
 		if (text.isValid()) {
-			guiShader_.useProgram();
 			text.bindTexture();
+			// Use the whole texture.
+			addQuad(x, y, text.getWidth(), text.getHeight(), 0, 0, 1, 1, getBoundTexture(), DrawList::TEXT);
+		}
+	}
+
+	void Graphic::drawText(const GlyphText& text, float x, float y) const {
+		if (const mw::Text* prerendered = text.getPrerendered()) {
+			drawText(*prerendered, x, y);
+		} else if (text.isValid()) {
+			GlyphAtlas& atlas = *text.getAtlas();
+			GLuint texture = atlas.bindTexture();
+			float invW = 1.f / atlas.getWidth();
+			float invH = 1.f / atlas.getHeight();
+			for (const GlyphQuad& quad : text.getQuads()) {
+				addQuad(x + quad.x_, y + quad.y_, quad.width_, quad.height_,
+					quad.atlasX_ * invW, quad.atlasY_ * invH,
+					(quad.atlasX_ + quad.width_) * invW, (quad.atlasY_ + quad.height_) * invH,
+					texture, DrawList::TEXT);
+			}
+		}
+	}
+
+	void Graphic::flush() const {
+		batch_->flush();
+		guiShader_.resetBoundProgram();
+	}
+
+	void Graphic::pushClip(const Rect& rect) const {
+		pushClip(rect, true);
+	}
+
+	void Graphic::pushWindowClip() const {
+		Rect rect = layers_.empty() ? windowRect_ : layers_.back().rect_;
+		if (!clips_.empty()) {
+			rect = rect.intersect(clips_.front());
+		}
+		pushClip(rect, false);
+	}
+
+	void Graphic::pushClip(const Rect& rect, bool intersect) const {
+		if (clips_.empty() || !intersect) {
+			clips_.push_back(rect);
+		} else {
+			clips_.push_back(rect.intersect(clips_.back()));
+		}
+		if (drawList_ != nullptr) {
+			// The clip stack is only kept for getVisibleRect().
+			drawList_->pushClip(rect, intersect);
+			return;
+		}
+		batch_->flush();
+		applyClip();
+	}
 
-			mw::Matrix44f uPos(
-				text.getWidth(), 0, 0, x,
-				0, text.getHeight(), 0, y,
-				0, 0, 1, 0,
-				0, 0, 0, 1
-			);
-			guiShader_.setUPos(uPos);
+	void Graphic::popClip() const {
+		clips_.pop_back();
+		if (drawList_ != nullptr) {
+			drawList_->popClip();
+			return;
+		}
+		batch_->flush();
+		applyClip();
+	}
 
-			// Send the whole texture => I_44.
-			guiShader_.setUTex(mw::Matrix44f::I);
+	Rect Graphic::getVisibleRect() const {
+		Rect rect = layers_.empty() ? windowRect_ : layers_.back().rect_;
+		if (!clips_.empty()) {
+			rect = rect.intersect(clips_.back());
+		}
+		return rect;
+	}
 
-			// Use as texture!
-			guiShader_.setUIsTex(true);
-			draw();
+	void Graphic::applyClip() const {
+		if (clips_.empty()) {
+			glDisable(GL_SCISSOR_TEST);
+			return;
+		}
+		Rect clip = clips_.back();
+		if (!layers_.empty()) {
+			// The layer's rectangle starts at the render target's origin.
+			clip.x_ -= layers_.back().rect_.x_;
+			clip.y_ -= layers_.back().rect_.y_;
+		}
+		int x = (int) std::floor(clip.x_);
+		int y = (int) std::floor(clip.y_);
+		glEnable(GL_SCISSOR_TEST);
+		glScissor(x, y, (int) std::ceil(clip.x_ + clip.width_) - x, (int) std::ceil(clip.y_ + clip.height_) - y);
+	}
+
+	int Graphic::getDrawCalls() const {
+		return batch_ ? batch_->getDrawCalls() : 0;
+	}
+
+	int Graphic::getTextureBinds() const {
+		return batch_ ? batch_->getTextureBinds() : 0;
+	}
+
+	void Graphic::resetCounters() const {
+		guiShader_.resetCounters();
+		if (batch_) {
+			batch_->resetCounters();
+		}
+	}
+
+	void Graphic::setBatching(bool batching) {
+		if (batch_ && batching_ && !batching) {
+			batch_->flush();
+		}
+		batching_ = batching;
+	}
+
+	void Graphic::addQuad(float x, float y, float w, float h) const {
+		if (drawList_ != nullptr) {
+			drawList_->addQuad(x, y, w, h, color_);
+			return;
+		}
+		batch_->addQuad(x, y, w, h, color_);
+		if (!batching_) {
+			batch_->flush();
+		}
+	}
+
+	void Graphic::addQuad(float x, float y, float w, float h,
+		float u, float v, float u2, float v2, GLuint texture, DrawList::Kind kind) const {
+
+		if (drawList_ != nullptr) {
+			drawList_->addQuad(kind, x, y, w, h, u, v, u2, v2, color_, texture);
+			return;
+		}
+		batch_->addQuad(x, y, w, h, u, v, u2, v2, color_, texture);
+		if (!batching_) {
+			batch_->flush();
 		}
 	}
 
 	void Graphic::setModel(const mw::Matrix44f& model) const {
-		guiShader_.setUModel(model);
+		model_ = model;
+		// The model matrix only translates and scales in 2D.
+		const float* m = model_.data();
+		if (batch_) {
+			batch_->setTransform(m[0], m[5], m[12], m[13]);
+		}
+		if (drawList_ != nullptr) {
+			drawList_->setTransform(m[0], m[5], m[12], m[13]);
+		}
 	}
 
-	void Graphic::setProj(const mw::Matrix44f& proj) {
-		proj_ = proj;
-		guiShader_.setUProj(proj);
+	void Graphic::beginRecording(DrawList& drawList) const {
+		batch_->flush();
+		drawList.clear();
+		drawList_ = &drawList;
+		setModel(model_);
+	}
+
+	void Graphic::endRecording(bool sort) const {
+		DrawList& drawList = *drawList_;
+		drawList_ = nullptr;
+		if (sort) {
+			drawList.sort();
+		} else {
+			drawList.transform();
+		}
+		submit(drawList);
 	}
 
-	void Graphic::draw() const {
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-		guiVertexData_->drawTRIANGLE_STRIP();
+	void Graphic::submit(const DrawList& drawList) const {
+		// The rectangles are already in window coordinates.
+		batch_->setTransform(1, 1, 0, 0);
+		for (int i = 0; i < drawList.getSize(); ++i) {
+			const DrawList::Command& command = drawList.getCommand(i);
+			Rect rect = drawList.getRect(i);
+			switch (command.kind_) {
+				case DrawList::PUSH_CLIP:
+					pushClip(rect);
+					break;
+				case DrawList::PUSH_WINDOW_CLIP:
+					pushClip(rect, false);
+					break;
+				case DrawList::POP_CLIP:
+					popClip();
+					break;
+				case DrawList::RECT:
+					batch_->addQuad(rect.x_, rect.y_, rect.width_, rect.height_, command.color_);
+					break;
+				default:
+					batch_->addQuad(rect.x_, rect.y_, rect.width_, rect.height_,
+						command.u_, command.v_, command.u2_, command.v2_, command.color_, command.texture_);
+					break;
+			}
+		}
+		batch_->flush();
+		setModel(model_);
+	}
 
-		glDisable(GL_BLEND);
+	void Graphic::beginLayer(RenderTarget& renderTarget, const Rect& rect) const {
+		// Layers are drawn directly, not recorded.
+		assert(drawList_ == nullptr);
+		batch_->flush();
+		layers_.push_back(LayerState{proj_, clips_, rect});
+		clips_.clear();
+
+		renderTarget.bind();
+		batch_->setLayerTarget(true);
+		applyClip();
+		GLfloat clearColor[4];
+		glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+		glClearColor(0, 0, 0, 0);
+		glClear(GL_COLOR_BUFFER_BIT);
+		glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+		setProj(mw::getOrthoProjectionMatrix44<GLfloat>(rect.x_, rect.x_ + renderTarget.getWidth(), rect.y_, rect.y_ + renderTarget.getHeight()));
+	}
+
+	void Graphic::endLayer(RenderTarget& renderTarget) const {
+		batch_->flush();
+		LayerState state = layers_.back();
+		layers_.pop_back();
+
+		renderTarget.unbind();
+		batch_->setLayerTarget(!layers_.empty());
+		clips_ = state.clips_;
+		applyClip();
+		setProj(state.proj_);
+	}
+
+	void Graphic::drawLayer(const RenderTarget& renderTarget, float w, float h) const {
+		mw::Color color = color_;
+		batch_->setBlend(GuiBatch::BLEND_PREMULTIPLIED);
+		setColor(1, 1, 1);
+		addQuad(0, 0, w, h, 0, 0, 1, 1, renderTarget.getTexture());
+		batch_->setBlend(GuiBatch::BLEND_ALPHA);
+		setColor(color);
+	}
+
+	void Graphic::setProj(const mw::Matrix44f& proj) const {
+		// The collected quads belongs to the old projection.
+		if (batch_) {
+			batch_->flush();
+		}
+		proj_ = proj;
+		guiShader_.setUProj(proj);
 	}
 
 } // Namespace gui.
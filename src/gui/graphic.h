@@ -7,13 +7,47 @@
 #include <mw/text.h>
 #include <mw/color.h>
 #include <mw/sprite.h>
-#include <mw/vertexbufferobject.h>
 
 #include "guishader.h"
-#include "guivertexdata.h"
+#include "guibatch.h"
+#include "glyphtext.h"
+#include "rendertarget.h"
+#include "dimension.h"
+#include "drawlist.h"
+
+#include <memory>
+#include <vector>
 
 namespace gui {
 
+	// A sprite and the id of its texture. The id is read from OpenGL the
+	// first time the sprite is drawn, instead of for each draw, and is
+	// reset when the sprite is replaced. Used for sprites drawn each frame.
+	class BoundSprite {
+	public:
+		friend class Graphic;
+
+		BoundSprite() : textureId_(0) {
+		}
+
+		BoundSprite(const mw::Sprite& sprite) : sprite_(sprite), textureId_(0) {
+		}
+
+		BoundSprite& operator=(const mw::Sprite& sprite) {
+			sprite_ = sprite;
+			textureId_ = 0;
+			return *this;
+		}
+
+		const mw::Sprite& getSprite() const {
+			return sprite_;
+		}
+
+	private:
+		mw::Sprite sprite_;
+		mutable GLuint textureId_;
+	};
+
 	class Graphic {
 	public:
 		friend class Frame;
@@ -23,8 +57,13 @@ namespace gui {
 		Graphic(std::string vShaderFile, std::string fShaderFile);
 		
 		void drawSquare(float x, float y, float w, float h) const;
+		// The texture id is read from OpenGL for each call, prefer BoundSprite
+		// for sprites drawn each frame.
 		void drawSprite(const mw::Sprite& sprite, float x, float y, float w, float h) const;
+		void drawSprite(const BoundSprite& sprite, float x, float y, float w, float h) const;
+		// The texture id is read from OpenGL for each call, the widgets use GlyphText.
 		void drawText(const mw::Text& text, float x, float y) const;
+		void drawText(const GlyphText& text, float x, float y) const;
 		void drawBorder(float x, float y, float w, float h) const;
 
 		inline const mw::Matrix44f& getProjectionMatrix() const {
@@ -34,22 +73,125 @@ namespace gui {
 		void setColor(const mw::Color& color) const;
 
 		void setColor(float red, float green, float blue, float alpha = 1) const;
+
+		// Draw all batched quads. Must be called before drawing
+		// directly with OpenGL. The shader program is bound again
+		// by the next draw.
+		void flush() const;
+
+		// Only draw inside the rectangle, in window coordinates, until popClip()
+		// is called. The rectangle is limited by the current clip rectangle.
+		void pushClip(const Rect& rect) const;
+
+		void popClip() const;
+
+		// Only draw inside the outermost clip rectangle, e.g. the frame's
+		// redrawn region, until popClip() is called. Used by components drawn
+		// on top of their parents, e.g. a drop down list.
+		void pushWindowClip() const;
+
+		// Return the part of the window, in window coordinates, that can be
+		// drawn to, i.e. limited by the current clip rectangle.
+		Rect getVisibleRect() const;
+
+		// When batching is active, the quads are collected and drawn
+		// together. Else each quad is drawn directly. Default is true.
+		void setBatching(bool batching);
+
+		bool isBatching() const {
+			return batching_;
+		}
+
+		// Panels unchanged for this number of frames are drawn to a cached
+		// texture. Zero turns the automatic caching off. Default is zero.
+		void setCacheThreshold(int frames) {
+			cacheThreshold_ = frames;
+		}
+
+		int getCacheThreshold() const {
+			return cacheThreshold_;
+		}
+
+		// Return the number of draw calls in the current frame.
+		int getDrawCalls() const;
+
+		// Return the number of texture binds in the current frame.
+		int getTextureBinds() const;
+
+		// Return the number of shader program binds and uniform uploads,
+		// issued and skipped, in the current frame.
+		const GuiShader::Counters& getShaderCounters() const {
+			return guiShader_.getCounters();
+		}
 	
 	private:
-		inline void useProgram() const {
-			guiShader_.useProgram();
+		struct LayerState {
+			mw::Matrix44f proj_;
+			std::vector<Rect> clips_;
+			Rect rect_;
+		};
+
+		void loadShaders(std::string vShaderFile, std::string fShaderFile);
+
+		// Add the quad for the sprite, which texture must be bound.
+		void addSprite(const mw::Sprite& sprite, GLuint texture, float x, float y, float w, float h) const;
+
+		// Draw to the render target until endLayer() is called. The rectangle,
+		// in window coordinates, is mapped to the whole render target.
+		void beginLayer(RenderTarget& renderTarget, const Rect& rect) const;
+
+		void endLayer(RenderTarget& renderTarget) const;
+
+		// Draw the layer's texture, which holds premultiplied color.
+		void drawLayer(const RenderTarget& renderTarget, float w, float h) const;
+
+		void addQuad(float x, float y, float w, float h) const;
+		void addQuad(float x, float y, float w, float h,
+			float u, float v, float u2, float v2, GLuint texture,
+			DrawList::Kind kind = DrawList::SPRITE) const;
+
+		// Record the drawing to the draw list, instead of drawing, until
+		// endRecording() is called.
+		void beginRecording(DrawList& drawList) const;
+
+		// Draw the recorded list, ordered by texture if sort is true.
+		void endRecording(bool sort) const;
+
+		bool isRecording() const {
+			return drawList_ != nullptr;
 		}
 
-		void draw() const;
+		void submit(const DrawList& drawList) const;
 
 		void setModel(const mw::Matrix44f& model) const;
 
-		void setProj(const mw::Matrix44f& proj);
+		void setProj(const mw::Matrix44f& proj) const;
+
+		// Set the window's rectangle, used when nothing is clipped.
+		void setWindowRect(const Rect& rect) {
+			windowRect_ = rect;
+		}
+
+		// Push the rectangle, limited by the current clip rectangle if intersect is true.
+		void pushClip(const Rect& rect, bool intersect) const;
+
+		// Set the scissor test to the current clip rectangle.
+		void applyClip() const;
+
+		void resetCounters() const;
 
-		mw::Matrix44f proj_;
+		mutable mw::Matrix44f proj_;
+		mutable std::vector<LayerState> layers_;
+		mutable std::vector<Rect> clips_;
+		Rect windowRect_;
+		mutable mw::Matrix44f model_;
+		mutable mw::Color color_;
+		bool batching_;
+		int cacheThreshold_;
+		mutable DrawList* drawList_;
 
 		GuiShader guiShader_;
-		std::shared_ptr<GuiVertexData> guiVertexData_;
+		std::shared_ptr<GuiBatch> batch_;
 	};
 
 } // Namespace gui.
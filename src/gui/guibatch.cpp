@@ -0,0 +1,158 @@
+#include "guibatch.h"
+#include "recttransform.h"
+
+namespace gui {
+
+	GuiBatch::GuiBatch(const GuiShader& guiShader) : guiShader_(guiShader),
+		transform_{0, 1, 1, 0, 0}, vbo_(0), vboSize_(0), texture_(0),
+		blend_(BLEND_ALPHA), layerTarget_(false), drawCalls_(0), textureBinds_(0) {
+	}
+
+	GuiBatch::~GuiBatch() {
+		if (vbo_ != 0) {
+			glDeleteBuffers(1, &vbo_);
+		}
+	}
+
+	void GuiBatch::setTransform(float scaleX, float scaleY, float x, float y) {
+		transform_.scaleX_ = scaleX;
+		transform_.scaleY_ = scaleY;
+		transform_.x_ = x;
+		transform_.y_ = y;
+	}
+
+	void GuiBatch::setBlend(Blend blend) {
+		if (blend_ != blend) {
+			flush();
+			blend_ = blend;
+		}
+	}
+
+	void GuiBatch::setLayerTarget(bool layerTarget) {
+		if (layerTarget_ != layerTarget) {
+			flush();
+			layerTarget_ = layerTarget;
+		}
+	}
+
+	void GuiBatch::addQuad(float x, float y, float w, float h, const mw::Color& color) {
+		// Quads without texture ignores the bound texture, no need to break the batch.
+		addQuad(x, y, w, h, 0, 0, 0, 0, color, 0.f);
+	}
+
+	void GuiBatch::addQuad(float x, float y, float w, float h,
+		float u, float v, float u2, float v2,
+		const mw::Color& color, GLuint texture) {
+
+		if (texture_ != 0 && texture_ != texture) {
+			flush();
+		}
+		texture_ = texture;
+		addQuad(x, y, w, h, u, v, u2, v2, color, 1.f);
+	}
+
+	void GuiBatch::addQuad(float x, float y, float w, float h,
+		float u, float v, float u2, float v2,
+		const mw::Color& color, float isTex) {
+
+		const Transform& last = transforms_.empty() ? transform_ : transforms_.back();
+		if (transforms_.empty() || last.scaleX_ != transform_.scaleX_ || last.scaleY_ != transform_.scaleY_
+			|| last.x_ != transform_.x_ || last.y_ != transform_.y_) {
+
+			transform_.first_ = (int) rects_.size() / 4;
+			transforms_.push_back(transform_);
+		}
+		rects_.insert(rects_.end(), {x, y, w, h});
+		attributes_.insert(attributes_.end(), {
+			u, v, u2, v2,
+			color.red_, color.green_, color.blue_, color.alpha_,
+			isTex
+		});
+	}
+
+	void GuiBatch::flush() {
+		if (rects_.empty()) {
+			return;
+		}
+
+		// Move all quads to window coordinates.
+		int quads = (int) rects_.size() / 4;
+		for (unsigned int i = 0; i < transforms_.size(); ++i) {
+			const Transform& transform = transforms_[i];
+			int end = i + 1 < transforms_.size() ? transforms_[i + 1].first_ : quads;
+			transformRects(rects_.data() + transform.first_ * 4, end - transform.first_,
+				transform.scaleX_, transform.scaleY_, transform.x_, transform.y_);
+		}
+
+		data_.clear();
+		for (int i = 0; i < quads; ++i) {
+			const GLfloat* rect = rects_.data() + i * 4;
+			const GLfloat* attributes = attributes_.data() + i * 9;
+			addVertexes(rect[0], rect[1], rect[2], rect[3],
+				attributes[0], attributes[1], attributes[2], attributes[3],
+				attributes + 4, attributes[8]);
+		}
+
+		if (vbo_ == 0) {
+			glGenBuffers(1, &vbo_);
+		}
+		guiShader_.useProgram();
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+		GLsizeiptr size = data_.size() * sizeof(GLfloat);
+		if (size > vboSize_) {
+			glBufferData(GL_ARRAY_BUFFER, size, data_.data(), GL_DYNAMIC_DRAW);
+			vboSize_ = size;
+		} else {
+			glBufferSubData(GL_ARRAY_BUFFER, 0, size, data_.data());
+		}
+		guiShader_.setVertexAttribPointer();
+
+		if (texture_ != 0) {
+			glBindTexture(GL_TEXTURE_2D, texture_);
+			++textureBinds_;
+		}
+
+		glEnable(GL_BLEND);
+		if (blend_ == BLEND_PREMULTIPLIED) {
+			glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+		} else if (layerTarget_) {
+			// The alpha is the coverage, blending alpha by itself gives a².
+			glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+		} else {
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		}
+		glDrawArrays(GL_TRIANGLES, 0, data_.size() / GuiShader::vertexSizeInFloat());
+		++drawCalls_;
+		glDisable(GL_BLEND);
+
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		rects_.clear();
+		attributes_.clear();
+		transforms_.clear();
+		texture_ = 0;
+	}
+
+	void GuiBatch::addVertex(float x, float y, float u, float v, const GLfloat* color, float isTex) {
+		data_.insert(data_.end(), {
+			x, y,
+			u, v,
+			color[0], color[1], color[2], color[3],
+			isTex
+		});
+	}
+
+	void GuiBatch::addVertexes(float x, float y, float w, float h,
+		float u, float v, float u2, float v2,
+		const GLfloat* color, float isTex) {
+
+		// Two triangles.
+		addVertex(x, y, u, v, color, isTex);
+		addVertex(x + w, y, u2, v, color, isTex);
+		addVertex(x, y + h, u, v2, color, isTex);
+
+		addVertex(x, y + h, u, v2, color, isTex);
+		addVertex(x + w, y, u2, v, color, isTex);
+		addVertex(x + w, y + h, u2, v2, color, isTex);
+	}
+
+} // Namespace gui.
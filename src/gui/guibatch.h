@@ -0,0 +1,111 @@
+#ifndef GUI_GUIBATCH_H
+#define GUI_GUIBATCH_H
+
+#include "guishader.h"
+
+#include <mw/opengl.h>
+#include <mw/color.h>
+
+#include <vector>
+
+namespace gui {
+
+	// A CPU side vertex stream of colored and textured quads. The quads are
+	// collected until flush() is called or until a quad with a new texture
+	// is added, and are then drawn with one draw call. The quads are moved
+	// to window coordinates by the 2D transform, all together when flushed.
+	class GuiBatch {
+	public:
+		// How the quads are blended with the target.
+		enum Blend {
+			BLEND_ALPHA, // The color has a separate alpha.
+			BLEND_PREMULTIPLIED // The color is multiplied by alpha, e.g. a layer.
+		};
+
+		GuiBatch(const GuiShader& guiShader);
+
+		~GuiBatch();
+
+		GuiBatch(const GuiBatch&) = delete;
+		GuiBatch& operator=(const GuiBatch&) = delete;
+
+		// Set the transform used by the quads added after this call. The
+		// position is scaled and then translated to window coordinates.
+		void setTransform(float scaleX, float scaleY, float x, float y);
+
+		// Add a quad without texture.
+		void addQuad(float x, float y, float w, float h, const mw::Color& color);
+
+		// Add a textured quad.
+		// (u, v) is the texture coordinate in the lower left corner and
+		// (u2, v2) in the upper right corner.
+		void addQuad(float x, float y, float w, float h,
+			float u, float v, float u2, float v2,
+			const mw::Color& color, GLuint texture);
+
+		// Draw all collected quads.
+		void flush();
+
+		// Set the blending of the quads added after this call. Default is BLEND_ALPHA.
+		void setBlend(Blend blend);
+
+		// Set to true when drawing to a layer. The layer then gets the
+		// coverage as alpha and the color multiplied by alpha, and must be
+		// drawn with BLEND_PREMULTIPLIED. Default is false.
+		void setLayerTarget(bool layerTarget);
+
+		bool isEmpty() const {
+			return rects_.empty();
+		}
+
+		// Return the number of draw calls since the last call to resetCounters().
+		int getDrawCalls() const {
+			return drawCalls_;
+		}
+
+		// Return the number of texture binds since the last call to resetCounters().
+		int getTextureBinds() const {
+			return textureBinds_;
+		}
+
+		void resetCounters() {
+			drawCalls_ = 0;
+			textureBinds_ = 0;
+		}
+
+	private:
+		// The quads from the first quad and forward use the transform.
+		struct Transform {
+			int first_;
+			float scaleX_, scaleY_;
+			float x_, y_;
+		};
+
+		void addQuad(float x, float y, float w, float h,
+			float u, float v, float u2, float v2,
+			const mw::Color& color, float isTex);
+
+		void addVertex(float x, float y, float u, float v, const GLfloat* color, float isTex);
+
+		void addVertexes(float x, float y, float w, float h,
+			float u, float v, float u2, float v2,
+			const GLfloat* color, float isTex);
+
+		GuiShader guiShader_;
+		std::vector<GLfloat> rects_; // Position and size of each quad.
+		std::vector<GLfloat> attributes_; // Texture coordinates, color and texture flag of each quad.
+		std::vector<Transform> transforms_;
+		Transform transform_;
+		std::vector<GLfloat> data_;
+		GLuint vbo_;
+		GLsizeiptr vboSize_;
+		GLuint texture_; // Texture used by the collected quads, 0 if none.
+		Blend blend_;
+		bool layerTarget_;
+		int drawCalls_;
+		int textureBinds_;
+	};
+
+} // Namespace gui.
+
+#endif // GUI_GUIBATCH_H
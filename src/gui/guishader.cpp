@@ -1,65 +1,79 @@
 #include "guishader.h"
 
+#include <algorithm>
+
 namespace gui {
 	
-	GuiShader::GuiShader() {
+	GuiShader::GuiShader() : state_(std::make_shared<State>()) {
+		resetBoundProgram();
+		state_->uProjValid_ = false;
+		resetCounters();
 		aPos_ = -1;
+		aTex_ = -1;
+		aColor_ = -1;
+		aIsTex_ = -1;
+		uProj_ = -1;
 	}
 		
-	GuiShader::GuiShader(std::string vShaderFile, std::string fShaderFile) {
+	GuiShader::GuiShader(std::string vShaderFile, std::string fShaderFile) : GuiShader() {
 		shader_.bindAttribute("aPos");
+		shader_.bindAttribute("aTex");
+		shader_.bindAttribute("aColor");
+		shader_.bindAttribute("aIsTex");
 		shader_.loadAndLinkFromFile(vShaderFile, fShaderFile);
 		
 		shader_.useProgram();
 	
+		// Collect the vertex buffer attributes indexes.
 		aPos_ = shader_.getAttributeLocation("aPos");
+		aTex_ = shader_.getAttributeLocation("aTex");
+		aColor_ = shader_.getAttributeLocation("aColor");
+		aIsTex_ = shader_.getAttributeLocation("aIsTex");
 
 		// Collect the vertex buffer uniforms indexes.
 		uProj_ = shader_.getUniformLocation("uProj");
-		uModel_ = shader_.getUniformLocation("uModel");
-		uPos_ = shader_.getUniformLocation("uPos");
-		uTex_ = shader_.getUniformLocation("uTex");
-		uColor_ = shader_.getUniformLocation("uColor");
-		uIsTex_ = shader_.getUniformLocation("uIsTex");
 	}
 	
 	void GuiShader::useProgram() const {
+		if (state_->programBound_) {
+			++state_->counters_.skippedProgramBinds_;
+			return;
+		}
 		shader_.useProgram();
+		state_->programBound_ = true;
+		++state_->counters_.programBinds_;
+	}
+
+	void GuiShader::resetBoundProgram() const {
+		state_->programBound_ = false;
+	}
+
+	void GuiShader::resetCounters() const {
+		state_->counters_ = Counters{0, 0, 0, 0};
 	}
 	
 	void GuiShader::setVertexAttribPointer() const {
 		glEnableVertexAttribArray(aPos_);
 		glVertexAttribPointer(aPos_, 2, GL_FLOAT, GL_FALSE, vertexSizeInBytes(), (GLvoid*) (sizeof(GLfloat) * 0));
+		glEnableVertexAttribArray(aTex_);
+		glVertexAttribPointer(aTex_, 2, GL_FLOAT, GL_FALSE, vertexSizeInBytes(), (GLvoid*) (sizeof(GLfloat) * 2));
+		glEnableVertexAttribArray(aColor_);
+		glVertexAttribPointer(aColor_, 4, GL_FLOAT, GL_FALSE, vertexSizeInBytes(), (GLvoid*) (sizeof(GLfloat) * 4));
+		glEnableVertexAttribArray(aIsTex_);
+		glVertexAttribPointer(aIsTex_, 1, GL_FLOAT, GL_FALSE, vertexSizeInBytes(), (GLvoid*) (sizeof(GLfloat) * 8));
 	}
 	
 	void GuiShader::setUProj(const mw::Matrix44<float>& matrix) const {
-		shader_.useProgram();
+		// The uniform value is kept by the program, even when another program is bound.
+		if (state_->uProjValid_ && std::equal(matrix.data(), matrix.data() + 16, state_->uProj_)) {
+			++state_->counters_.skippedUniformUploads_;
+			return;
+		}
+		useProgram();
 		glUniformMatrix4fv(uProj_, 1, false, matrix.data());
-	}
-	
-	void GuiShader::setUModel(const mw::Matrix44<float>& matrix) const {
-		shader_.useProgram();
-		glUniformMatrix4fv(uModel_, 1, false, matrix.data());
-	}
-	
-	void GuiShader::setUPos(const mw::Matrix44<float>& matrix) const {
-		shader_.useProgram();
-		glUniformMatrix4fv(uPos_, 1, false, matrix.data());
-	}
-	
-	void GuiShader::setUTex(const mw::Matrix44<float>& matrix) const {
-		shader_.useProgram();
-		glUniformMatrix4fv(uTex_, 1, false, matrix.data());
-	}
-	
-	void GuiShader::setUColor(const mw::Color& color) const {
-		shader_.useProgram();
-		glUniform4f(uColor_, color.red_, color.green_, color.blue_, color.alpha_);
-	}
-	
-	void GuiShader::setUIsTex(float value) const {
-		shader_.useProgram();
-		glUniform1f(uIsTex_, value);
+		std::copy(matrix.data(), matrix.data() + 16, state_->uProj_);
+		state_->uProjValid_ = true;
+		++state_->counters_.uniformUploads_;
 	}
 
 } // Namespace gui
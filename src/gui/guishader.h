@@ -5,18 +5,30 @@
 #include <mw/matrix44.h>
 #include <mw/color.h>
 
+#include <memory>
 #include <string>
 
 namespace gui {	
 	
+	// The shader used to draw the gui. Copies share the same program, and
+	// the program binding and uniform values are cached, so redundant OpenGL
+	// calls are skipped.
 	class GuiShader {
 	public:
+		struct Counters {
+			int programBinds_;
+			int skippedProgramBinds_;
+			int uniformUploads_;
+			int skippedUniformUploads_;
+		};
+
 		static constexpr unsigned int vertexSizeInBytes() {
 			return vertexSizeInFloat() * sizeof(GLfloat);
 		}
 	
+		// Position (2), texture coordinate (2), color (4) and texture flag (1).
 		static constexpr unsigned int vertexSizeInFloat() {
-			return 2;
+			return 9;
 		}
 	
 		GuiShader();
@@ -28,23 +40,35 @@ namespace gui {
 		void setVertexAttribPointer() const;
 	
 		void setUProj(const mw::Matrix44<float>& matrix) const;
-		void setUModel(const mw::Matrix44<float>& matrix) const;
-		void setUPos(const mw::Matrix44<float>& matrix) const;
-		void setUTex(const mw::Matrix44<float>& matrix) const;
-		
-		void setUColor(const mw::Color& color) const;
-		void setUIsTex(float value) const;
+
+		// Must be called when another program may have been bound,
+		// e.g. after drawing directly with OpenGL.
+		void resetBoundProgram() const;
+
+		// Return the number of OpenGL calls issued and skipped since
+		// the last call to resetCounters().
+		const Counters& getCounters() const {
+			return state_->counters_;
+		}
+
+		void resetCounters() const;
 	
 	private:
+		struct State {
+			bool programBound_;
+			bool uProjValid_;
+			GLfloat uProj_[16];
+			Counters counters_;
+		};
+
 		int aPos_;
+		int aTex_;
+		int aColor_;
+		int aIsTex_;
 		int uProj_;
-		int uModel_;
-		int uPos_;
-		int uTex_;
-		int uColor_;
-		int uIsTex_;
 
 		mw::Shader shader_;
+		std::shared_ptr<State> state_;
 	};
 
 } // Namespace gui.
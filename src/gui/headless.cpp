@@ -0,0 +1,103 @@
+#include "headless.h"
+
+#include <SDL_ttf.h>
+
+#include <iostream>
+
+namespace gui {
+
+	Headless::Headless(std::unique_ptr<Frame> frame, int width, int height) : frame_(std::move(frame)),
+		width_(width), height_(height), videoInit_(false), ttfInit_(false), window_(nullptr), context_(nullptr) {
+
+#if defined(__linux__)
+		if (SDL_getenv("DISPLAY") == nullptr && SDL_getenv("WAYLAND_DISPLAY") == nullptr) {
+			// No display server, use a EGL pbuffer.
+			SDL_setenv("SDL_VIDEODRIVER", "offscreen", 0);
+		}
+#endif
+		if (SDL_InitSubSystem(SDL_INIT_VIDEO) != 0) {
+			std::cerr << "Headless failed to initiate the video: " << SDL_GetError() << "\n";
+			return;
+		}
+		videoInit_ = true;
+		if (!TTF_WasInit()) {
+			ttfInit_ = TTF_Init() == 0;
+		}
+
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 2);
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 1);
+		window_ = SDL_CreateWindow("", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+			width, height, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+		if (window_ != nullptr) {
+			context_ = SDL_GL_CreateContext(window_);
+		}
+		if (context_ == nullptr) {
+			std::cerr << "Headless failed to create a OpenGL context: " << SDL_GetError() << "\n";
+			return;
+		}
+#if !MW_OPENGLES2
+		// Normally done by mw::Window::startLoop(), which is never called.
+		glewExperimental = GL_TRUE;
+		GLenum error = glewInit();
+		if (error != GLEW_OK) {
+			std::cerr << "Headless failed to initiate GLEW: " << glewGetErrorString(error) << "\n";
+			SDL_GL_DeleteContext(context_);
+			context_ = nullptr;
+			return;
+		}
+#endif
+
+		// The frame is drawn to the render target, never to the hidden window.
+		renderTarget_ = std::make_unique<RenderTarget>(width, height);
+		renderTarget_->bind();
+		frame_->setWindowSize(width, height);
+		// Nothing is swapped, step() returns after drawing.
+		frame_->swapping_ = false;
+		frame_->initPreLoop();
+	}
+
+	Headless::~Headless() {
+		// The frame's buffers, shaders and textures need the context.
+		frame_ = nullptr;
+		if (context_ != nullptr) {
+			renderTarget_ = nullptr;
+			SDL_GL_DeleteContext(context_);
+		}
+		if (window_ != nullptr) {
+			SDL_DestroyWindow(window_);
+		}
+		if (ttfInit_) {
+			TTF_Quit();
+		}
+		if (videoInit_) {
+			SDL_QuitSubSystem(SDL_INIT_VIDEO);
+		}
+	}
+
+	void Headless::injectEvent(const SDL_Event& sdlEvent) {
+		if (isValid()) {
+			frame_->eventUpdate(sdlEvent);
+		}
+	}
+
+	void Headless::step(double deltaTime) {
+		if (isValid()) {
+			frame_->update(deltaTime);
+			glFinish();
+		}
+	}
+
+	std::vector<Uint8> Headless::readPixels(int x, int y, int width, int height) const {
+		std::vector<Uint8> pixels(width * height * 4);
+		if (isValid()) {
+			glPixelStorei(GL_PACK_ALIGNMENT, 1);
+			glReadPixels(x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+		}
+		return pixels;
+	}
+
+	std::vector<Uint8> Headless::readPixels() const {
+		return readPixels(0, 0, width_, height_);
+	}
+
+} // Namespace gui.
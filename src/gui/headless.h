@@ -0,0 +1,75 @@
+#ifndef GUI_HEADLESS_H
+#define GUI_HEADLESS_H
+
+#include "frame.h"
+#include "rendertarget.h"
+
+#include <SDL.h>
+
+#include <memory>
+#include <vector>
+
+namespace gui {
+
+	// Runs a frame without a visible window, e.g. in tests and benchmarks.
+	// The frame is drawn to a offscreen render target, using a hidden window's
+	// OpenGL context. On Linux without DISPLAY and WAYLAND_DISPLAY, SDL's
+	// "offscreen" video driver is used, i.e. the context is created on a EGL
+	// pbuffer and no display server is needed. A driver set by SDL_VIDEODRIVER
+	// is kept. Set the environment variable LIBGL_ALWAYS_SOFTWARE=1 to make
+	// Mesa use its software renderer (llvmpipe) on machines without a GPU.
+	// The frame is driven by step() instead of Frame::startLoop(). The frame
+	// is owned by Headless, i.e. its OpenGL resources are released before
+	// the context.
+	class Headless {
+	public:
+		Headless(std::unique_ptr<Frame> frame, int width, int height);
+
+		~Headless();
+
+		Headless(const Headless&) = delete;
+		Headless& operator=(const Headless&) = delete;
+
+		// Return true if the OpenGL context was created.
+		bool isValid() const {
+			return context_ != nullptr;
+		}
+
+		// Send the event to the frame, as if it came from SDL.
+		// I.e. the mouse coordinates has the y-axis pointing down.
+		void injectEvent(const SDL_Event& sdlEvent);
+
+		// Update and draw the frame once. Waits until the drawing is done.
+		void step(double deltaTime = 1 / 60.0);
+
+		// Return the RGBA pixels of the rectangle. The first row is the bottom row.
+		std::vector<Uint8> readPixels(int x, int y, int width, int height) const;
+
+		// Return the RGBA pixels of the whole frame. The first row is the bottom row.
+		std::vector<Uint8> readPixels() const;
+
+		Frame& getFrame() const {
+			return *frame_;
+		}
+
+		int getWidth() const {
+			return width_;
+		}
+
+		int getHeight() const {
+			return height_;
+		}
+
+	private:
+		std::unique_ptr<Frame> frame_;
+		int width_, height_;
+		bool videoInit_;
+		bool ttfInit_; // True if TTF was initiated by this object.
+		SDL_Window* window_;
+		SDL_GLContext context_;
+		std::unique_ptr<RenderTarget> renderTarget_;
+	};
+
+} // Namespace gui.
+
+#endif // GUI_HEADLESS_H
@@ -1,15 +1,21 @@
 #ifndef GUI_INPUTFORMATTER_H
 #define GUI_INPUTFORMATTER_H
 
-#include <sstream> // std::ostringstream
-#include <cstring> // std::memmove
+#include <algorithm> // std::max
+#include <cstring> // std::memmove, std::strlen
+#include <string>
+#include <string_view>
+#include <vector>
 
 namespace gui {
 
+	// Edits a utf8 string at a marker. The text is stored in a gap buffer,
+	// i.e. the free space is kept where the last edit was made. Edits next
+	// to each other only move the gap a few bytes, and the buffer grows by
+	// doubling, i.e. typing and pasting at the marker are amortized O(1)
+	// for each byte, independent of the text's length.
 	class InputFormatter {
 	public:
-		static int const MAX_SIZE = 100; // Max number of input characters.
-
 		enum Input {
 			INPUT_MOVE_MARKER_HOME,
 			INPUT_MOVE_MARKER_END,
@@ -20,7 +26,8 @@ namespace gui {
 		};
 
 		InputFormatter(int maxLimit = 30) {
-			size_ = 0;
+			gapStart_ = 0;
+			gapEnd_ = 0;
 			marker_ = 0;
 			maxLimit_ = maxLimit;
 			nbrOfCharacters_ = 0;
@@ -30,25 +37,40 @@ namespace gui {
 			return maxLimit_;
 		}
 
+		// Set the max number of bytes allowed by update().
 		void setMaxLimit(int maxLimit) {
-			if (maxLimit < MAX_SIZE) {
-				maxLimit_ = maxLimit;
-			}
+			maxLimit_ = maxLimit;
 		}
 
 		// Returns the current input.
 		// The return value is a utf8 string.
 		std::string getText() const {
-			std::ostringstream stream;
-			for (int i = 0; i < size_; ++i) {
-				stream << text_[i];
-			}
-			return stream.str();
+			std::string text;
+			text.reserve(getSize());
+			text.append(buffer_.data(), gapStart_);
+			text.append(buffer_.data() + gapEnd_, buffer_.size() - gapEnd_);
+			return text;
+		}
+
+		// Get the current input as the utf8 strings before and after the gap,
+		// without moving the gap. The last inserted bytes end the first string.
+		// Valid until the input is changed.
+		void getText(std::string_view& before, std::string_view& after) const {
+			before = std::string_view(buffer_.data(), gapStart_);
+			after = std::string_view(buffer_.data() + gapEnd_, buffer_.size() - gapEnd_);
 		}
 
-		// Clears the current input.
+		// Replace the current input, not limited by the max limit.
+		// The marker is placed at the end.
+		void setText(std::string_view text) {
+			clear();
+			insert(text.data(), (int) text.size());
+		}
+
+		// Clears the current input. The memory is kept.
 		void clear() {
-			size_ = 0;
+			gapStart_ = 0;
+			gapEnd_ = (int) buffer_.size();
 			marker_ = 0;
 			nbrOfCharacters_ = 0;
 		}
@@ -56,54 +78,45 @@ namespace gui {
 		// Takes a c-string which must be encoded in utf8 in order
 		// to work correctly.
 		void update(const char* text) {
-			int size = std::strlen(text);
-			int length = 1;
-			for (int i = 0; i < size; i += length) {
-				unsigned char token = text[i];
-				if (token < UTF8_BYTE_2) {
-					length = 1;
-				} else if (token < UTF8_BYTE_3) {
-					length = 2;
-				} else if (token < UTF8_BYTE_4) {
-					length = 3;
-				} else if (token < UTF8_BYTE_5) {
-					length = 4;
-				} else if (token < UTF8_BYTE_6) {
-					length = 5;
-				} else {
-					length = 6; // Assumes.
-				}
-				if (nbrOfCharacters_ + length > maxLimit_) {
+			int size = (int) std::strlen(text);
+			// Only whole characters, as long as the limit allows.
+			int bytes = 0;
+			while (bytes < size) {
+				int length = getUtf8Length(text[bytes]);
+				if (getSize() + bytes + length > maxLimit_) {
 					break;
 				}
-				addUtf8(text + i, length);
+				bytes += length;
 			}
+			insert(text, std::min(bytes, size));
 		}
 
 		// Updates the input.
 		void update(InputFormatter::Input input) {
 			switch (input) {
 				case INPUT_ERASE_LEFT:
-					removeChar(true);
+					if (marker_ > 0) {
+						int end = marker_;
+						marker_ = getPreviousPosition(marker_);
+						erase(marker_, end - marker_);
+					}
 					break;
 				case INPUT_ERASE_RIGHT:
-					removeChar(false);
+					if (marker_ < getSize()) {
+						erase(marker_, getNextPosition(marker_) - marker_);
+					}
 					break;
 				case INPUT_MOVE_MARKER_LEFT:
-					if (marker_ > 0) {
-						marker_ += -textUtf8_[marker_ - 1];
-					}
+					marker_ = getPreviousPosition(marker_);
 					break;
 				case INPUT_MOVE_MARKER_RIGHT:
-					if (marker_ < size_) {
-						marker_ += textUtf8_[marker_];
-					}
+					marker_ = getNextPosition(marker_);
 					break;
 				case INPUT_MOVE_MARKER_HOME:
 					marker_ = 0;
 					break;
 				case INPUT_MOVE_MARKER_END:
-					marker_ = size_;
+					marker_ = getSize();
 					break;
 			}
 		}
@@ -114,7 +127,7 @@ namespace gui {
 
 		// Returns the size of the current utf8 string.
 		int getSize() const {
-			return size_;
+			return (int) buffer_.size() - (gapEnd_ - gapStart_);
 		}
 
 		// Get the position for the marker. The position
@@ -123,59 +136,134 @@ namespace gui {
 			return marker_;
 		}
 
+		// Set the marker to the position in the utf8 string. Moved
+		// back to the start of the character, if inside a character.
+		void setMarkerPosition(int position) {
+			int size = getSize();
+			marker_ = position < 0 ? 0 : (position > size ? size : position);
+			while (marker_ > 0 && marker_ < size && isContinuation(at(marker_))) {
+				--marker_;
+			}
+		}
+
 	private:
-		// Remove one utf8 encoded character to the left or to the right of the marker.
-		// May remove several character due to the encoding.
-		void removeChar(bool leftMarker) {
-			if (leftMarker && marker_ > 0) {
-				nbrOfCharacters_ -= textUtf8_[marker_ - 1];
-				int dst = marker_ - textUtf8_[marker_ - 1];
-				int src = marker_;
-				int size = size_ - marker_;
-				memmove(text_ + dst, text_ + src, size);
-				size_ -= textUtf8_[marker_ - 1];
-				marker_ -= textUtf8_[marker_ - 1];
-				memmove(textUtf8_ + dst, textUtf8_ + src, size);
-			} else if (!leftMarker && marker_ < size_) {
-				nbrOfCharacters_ -= textUtf8_[marker_];
-				int dst = marker_;
-				int src = marker_ + textUtf8_[marker_];
-				int size = size_ - (marker_ + textUtf8_[marker_]);
-				memmove(text_ + dst, text_ + src, size);
-				size_ -= textUtf8_[marker_];
-				memmove(textUtf8_ + dst, textUtf8_ + src, size);
+		// Return the number of bytes of the utf8 character, based on the first byte.
+		static int getUtf8Length(char token) {
+			unsigned char byte = token;
+			if (byte < UTF8_BYTE_2) {
+				return 1;
+			} else if (byte < UTF8_BYTE_3) {
+				return 2;
+			} else if (byte < UTF8_BYTE_4) {
+				return 3;
+			} else if (byte < UTF8_BYTE_5) {
+				return 4;
+			} else if (byte < UTF8_BYTE_6) {
+				return 5;
+			}
+			return 6; // Assumes.
+		}
+
+		// Return true if the byte is inside a character, i.e. not the first byte.
+		static bool isContinuation(char token) {
+			return (token & 0xC0) == 0x80;
+		}
+
+		// Return the byte in the utf8 string, skipping the gap.
+		char at(int index) const {
+			return index < gapStart_ ? buffer_[index] : buffer_[index + gapEnd_ - gapStart_];
+		}
+
+		int getPreviousPosition(int position) const {
+			while (position > 0 && isContinuation(at(--position))) {
 			}
+			return position;
 		}
 
-		void addUtf8(const char* utf8Token, int length) {
-			if (size_ + length <= maxLimit_ && size_ + length <= MAX_SIZE) {
-				memmove(text_ + marker_ + length, text_ + marker_, size_ - marker_);
-				memmove(textUtf8_ + marker_ + length, textUtf8_ + marker_, size_ - marker_);
-				for (int i = 0; i < length; ++i) {
-					text_[marker_] = utf8Token[i];
-					textUtf8_[marker_] = length;
-					++marker_;
-					++size_;
+		int getNextPosition(int position) const {
+			int size = getSize();
+			if (position < size) {
+				++position;
+			}
+			while (position < size && isContinuation(at(position))) {
+				++position;
+			}
+			return position;
+		}
+
+		// Insert the bytes at the marker, and move the marker past them.
+		void insert(const char* text, int size) {
+			if (size <= 0) {
+				return;
+			}
+			moveGap(marker_);
+			reserveGap(size);
+			std::memcpy(buffer_.data() + gapStart_, text, size);
+			for (int i = 0; i < size; ++i) {
+				if (!isContinuation(text[i])) {
+					++nbrOfCharacters_;
 				}
-				nbrOfCharacters_ += length;
 			}
+			gapStart_ += size;
+			marker_ += size;
+		}
+
+		// Erase the bytes in the range [position, position + size).
+		void erase(int position, int size) {
+			moveGap(position);
+			for (int i = 0; i < size; ++i) {
+				if (!isContinuation(buffer_[gapEnd_ + i])) {
+					--nbrOfCharacters_;
+				}
+			}
+			gapEnd_ += size;
+		}
+
+		// Move the gap to the position in the utf8 string, only the
+		// bytes between the old and the new position are moved.
+		void moveGap(int position) {
+			if (position < gapStart_) {
+				int size = gapStart_ - position;
+				std::memmove(buffer_.data() + gapEnd_ - size, buffer_.data() + position, size);
+				gapStart_ -= size;
+				gapEnd_ -= size;
+			} else if (position > gapStart_) {
+				int size = position - gapStart_;
+				std::memmove(buffer_.data() + gapStart_, buffer_.data() + gapEnd_, size);
+				gapStart_ += size;
+				gapEnd_ += size;
+			}
+		}
+
+		// Make the gap at least the size, the buffer at least doubles.
+		void reserveGap(int size) {
+			if (gapEnd_ - gapStart_ >= size) {
+				return;
+			}
+			int tail = (int) buffer_.size() - gapEnd_;
+			int capacity = std::max(2 * (int) buffer_.size(), getSize() + size + MIN_GAP);
+			buffer_.resize(capacity);
+			// The text after the gap is moved to the new end.
+			std::memmove(buffer_.data() + capacity - tail, buffer_.data() + gapEnd_, tail);
+			gapEnd_ = capacity - tail;
 		}
 
 		// First code point. Source: https://en.wikipedia.org/wiki/UTF-8.
 		// Only the value of the first byte is of interest in order to see how many bytes
 		// each utf8 character contains.
-		unsigned const char UTF8_BYTE_1 = 0;
-		unsigned const char UTF8_BYTE_2 = 192;
-		unsigned const char UTF8_BYTE_3 = 224;
-		unsigned const char UTF8_BYTE_4 = 240;
-		unsigned const char UTF8_BYTE_5 = 248;
-		unsigned const char UTF8_BYTE_6 = 252;
-
-		int maxLimit_;				// Max number of input character allowed.
-		char text_[MAX_SIZE];		// Storage of text input.
-		char textUtf8_[MAX_SIZE];	// Correspond to number of bytes corresponding utf8 takes.
-		int size_;					// Size of the string.
+		static const unsigned char UTF8_BYTE_2 = 192;
+		static const unsigned char UTF8_BYTE_3 = 224;
+		static const unsigned char UTF8_BYTE_4 = 240;
+		static const unsigned char UTF8_BYTE_5 = 248;
+		static const unsigned char UTF8_BYTE_6 = 252;
+
+		static const int MIN_GAP = 16;
+
+		std::vector<char> buffer_;	// The text, with the gap in between.
+		int gapStart_;				// First byte of the gap.
+		int gapEnd_;				// First byte after the gap.
 		int marker_;				// Marker position.
+		int maxLimit_;				// Max number of input bytes allowed.
 		int nbrOfCharacters_;		// The number of readable (for a human) characters.
 	};
 
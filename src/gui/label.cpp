@@ -1,14 +1,16 @@
 #include "label.h"
 
 #include <mw/font.h>
-#include <mw/text.h>
 
 namespace gui {
 
-	Label::Label(std::string text, const mw::Font& font) : Label(mw::Text(text, font)) {
+	Label::Label(std::string text, const mw::Font& font) : Label(GlyphText(text, font)) {
 	}
 
-	Label::Label(mw::Text text) : text_(text), hTextAlignment_(HCENTER), vTextAlignment_(VCENTER) {
+	Label::Label(mw::Text text) : Label(GlyphText(text)) {
+	}
+
+	Label::Label(const GlyphText& text) : text_(text), vTextAlignment_(VCENTER), hTextAlignment_(HCENTER) {
 		if (text_.getWidth() > 1 && text_.getWidth() > 1) {
 			setPreferredSize(text_.getWidth() + 2, text_.getHeight() + 2);
 		}
@@ -52,7 +54,8 @@ namespace gui {
 	}
 
 	void Label::setFont(const mw::Font& font) {
-		text_ = mw::Text(text_.getText(), font);
+		text_ = GlyphText(text_.getText(), font);
+		repaint();
 	}
 
 	std::string Label::getText() const {
@@ -61,6 +64,7 @@ namespace gui {
 
 	void Label::setText(std::string text) {
 		text_.setText(text);
+		repaint();
 		if (text_.getWidth() > 1 && text_.getWidth() > 1) {
 			setPreferredSize(text_.getWidth() + 1, text_.getHeight() + 1);
 		}
@@ -72,6 +76,7 @@ namespace gui {
 	
 	void Label::setHorizontalAlignment(HorizontalAlignment alignment) {
 		hTextAlignment_ = alignment;
+		repaint();
 	}
 
 	Label::VerticalAlignment Label::getVerticalAlignment() const {
@@ -80,14 +85,17 @@ namespace gui {
 
 	void Label::setVerticalAlignment(VerticalAlignment alignment) {
 		vTextAlignment_ = alignment;
+		repaint();
 	}
 		
 	void Label::setTextColor(const mw::Color& color) {
 		textColor_ = color;
+		repaint();
 	}
 
 	void Label::setTextColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
 		textColor_ = mw::Color(red, green, blue, alpha);
+		repaint();
 	}
 
 } // Namespace gui.
@@ -2,7 +2,9 @@
 #define GUI_LABEL_H
 
 #include "component.h"
+#include "glyphtext.h"
 
+#include <mw/font.h>
 #include <mw/text.h>
 
 namespace gui {
@@ -23,6 +25,7 @@ namespace gui {
 
 		Label(std::string text, const mw::Font& font);
 		Label(mw::Text text);
+		Label(const GlyphText& text);
 
 		virtual ~Label() = default;
 
@@ -47,7 +50,7 @@ namespace gui {
 		void setTextColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha = 1);
 
 	private:
-		mw::Text text_;
+		GlyphText text_;
 		mw::Color textColor_;
 		VerticalAlignment vTextAlignment_;
 		HorizontalAlignment hTextAlignment_;
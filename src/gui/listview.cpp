@@ -0,0 +1,128 @@
+#include "listview.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace gui {
+
+	namespace {
+
+		// Number of rows scrolled by one step of the mouse wheel.
+		const float WHEEL_ROWS = 3;
+
+	}
+
+	ListView::ListView(const RowFactory& rowFactory, const RowRenderer& rowRenderer, float rowHeight)
+		: ListView(rowFactory, rowRenderer, rowHeight, 5, 5, 5) {
+	}
+
+	ListView::ListView(const RowFactory& rowFactory, const RowRenderer& rowRenderer, float rowHeight,
+		float hGap, float vGap, float vFirstGap) : rowFactory_(rowFactory), rowRenderer_(rowRenderer),
+		rowCount_(0), rowHeight_(rowHeight), hGap_(hGap), vGap_(vGap), vFirstGap_(vFirstGap),
+		scrollPosition_(0) {
+
+		setPreferredSize(150, 150);
+		// The row factory and renderer are user code, e.g. creating labels.
+		setSerialLayout();
+	}
+
+	void ListView::setRowCount(int rowCount) {
+		if (rowCount_ != rowCount) {
+			rowCount_ = rowCount;
+			refresh();
+		}
+	}
+
+	void ListView::setRowHeight(float rowHeight) {
+		if (rowHeight_ != rowHeight) {
+			rowHeight_ = rowHeight;
+			invalidate();
+		}
+	}
+
+	void ListView::setScrollPosition(float position) {
+		position = std::max(0.f, std::min(position, getMaxScrollPosition()));
+		if (scrollPosition_ != position) {
+			scrollPosition_ = position;
+			invalidate();
+		}
+	}
+
+	float ListView::getMaxScrollPosition() const {
+		float contentHeight = 2 * vFirstGap_ + rowCount_ * (rowHeight_ + vGap_) - vGap_;
+		return std::max(0.f, contentHeight - getSize().height_);
+	}
+
+	void ListView::scrollToRow(int index) {
+		float top = vFirstGap_ + index * (rowHeight_ + vGap_);
+		float height = getSize().height_;
+		if (top < scrollPosition_) {
+			setScrollPosition(top);
+		} else if (top + rowHeight_ > scrollPosition_ + height) {
+			setScrollPosition(top + rowHeight_ - height);
+		}
+	}
+
+	void ListView::refresh() {
+		std::fill(rowIndexes_.begin(), rowIndexes_.end(), -1);
+		invalidate();
+	}
+
+	void ListView::validate() {
+		repaint();
+		Dimension size = getSize();
+		scrollPosition_ = std::max(0.f, std::min(scrollPosition_, getMaxScrollPosition()));
+
+		// Rows in the range [first, last) are at least partly inside the view.
+		float stride = rowHeight_ + vGap_;
+		int first = std::max(0, (int) std::floor((scrollPosition_ - vFirstGap_) / stride));
+		int last = std::min(rowCount_, (int) std::ceil((scrollPosition_ + size.height_ - vFirstGap_) / stride));
+
+		if (getComponentsCount() < last - first) {
+			BatchUpdate batchUpdate(*this);
+			while (getComponentsCount() < last - first) {
+				add(DEFAULT_INDEX, rowFactory_());
+				rowIndexes_.push_back(-1);
+			}
+		}
+
+		const auto& rows = getComponents();
+		int count = (int) rows.size();
+		// Each row has its own component, as long as there are
+		// at least as many components as visible rows.
+		for (int index = first; index < last; ++index) {
+			int slot = index % count;
+			Component& row = *rows[slot];
+			if (rowIndexes_[slot] != index) {
+				rowIndexes_[slot] = index;
+				rowRenderer_(row, index);
+			}
+			row.setVisible(true);
+			row.setSize(size.width_ - 2 * hGap_, rowHeight_);
+			row.setLocation(hGap_, size.height_ + scrollPosition_ - vFirstGap_ - index * stride - rowHeight_);
+		}
+
+		for (int slot = 0; slot < count; ++slot) {
+			if (rowIndexes_[slot] < first || rowIndexes_[slot] >= last) {
+				rows[slot]->setVisible(false);
+			}
+		}
+	}
+
+	void ListView::draw(const Graphic& graphic, double deltaTime) {
+		// Rows partly inside the view must not be drawn outside.
+		graphic.pushClip(getWindowRect());
+		Panel::draw(graphic, deltaTime);
+		graphic.popClip();
+	}
+
+	void ListView::handleMouse(const SDL_Event& mouseEvent) {
+		if (mouseEvent.type == SDL_MOUSEWHEEL) {
+			setScrollPosition(scrollPosition_ - mouseEvent.wheel.y * WHEEL_ROWS * (rowHeight_ + vGap_));
+			Component::handleMouse(mouseEvent);
+		} else {
+			Panel::handleMouse(mouseEvent);
+		}
+	}
+
+} // Namespace gui.
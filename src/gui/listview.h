@@ -0,0 +1,77 @@
+#ifndef GUI_LISTVIEW_H
+#define GUI_LISTVIEW_H
+
+#include "panel.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace gui {
+
+	// A vertical list of rows with the same height. Only the rows inside the
+	// view are backed by components, which are reused when the list is scrolled.
+	// The rows are placed with the same gaps as VerticalLayout.
+	class ListView : public Panel {
+	public:
+		// Create a new row component.
+		using RowFactory = std::function<std::shared_ptr<Component>()>;
+
+		// Update the row component to show the row with the provided index.
+		using RowRenderer = std::function<void(Component& row, int index)>;
+
+		ListView(const RowFactory& rowFactory, const RowRenderer& rowRenderer, float rowHeight);
+
+		ListView(const RowFactory& rowFactory, const RowRenderer& rowRenderer, float rowHeight,
+			float hGap, float vGap, float vFirstGap);
+
+		virtual ~ListView() = default;
+
+		void setRowCount(int rowCount);
+
+		int getRowCount() const {
+			return rowCount_;
+		}
+
+		void setRowHeight(float rowHeight);
+
+		float getRowHeight() const {
+			return rowHeight_;
+		}
+
+		// Set the distance the content is scrolled down from the top.
+		void setScrollPosition(float position);
+
+		float getScrollPosition() const {
+			return scrollPosition_;
+		}
+
+		float getMaxScrollPosition() const;
+
+		// Scroll the least possible to make the row visible.
+		void scrollToRow(int index);
+
+		// Render all visible rows again, e.g. when the data is changed.
+		void refresh();
+
+		// Lay out the visible rows.
+		void validate() override;
+
+	protected:
+		void draw(const Graphic& graphic, double deltaTime) override;
+
+		void handleMouse(const SDL_Event& mouseEvent) override;
+
+	private:
+		RowFactory rowFactory_;
+		RowRenderer rowRenderer_;
+		std::vector<int> rowIndexes_; // The row shown by each row component, -1 if none.
+		int rowCount_;
+		float rowHeight_;
+		float hGap_, vGap_, vFirstGap_;
+		float scrollPosition_;
+	};
+
+} // Namespace gui.
+
+#endif // GUI_LISTVIEW_H
@@ -0,0 +1,106 @@
+#ifndef GUI_MPSCQUEUE_H
+#define GUI_MPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace gui {
+
+	// Bounded lock free queue, for many producer threads and one consumer
+	// thread. Each cell has a sequence number telling if it is free for the
+	// producers or filled for the consumer, i.e. the producers only compete
+	// for the enqueue position and never wait for each other.
+	template <class T>
+	class MpscQueue {
+	public:
+		// The capacity is rounded up to a power of two.
+		explicit MpscQueue(int capacity);
+
+		MpscQueue(const MpscQueue&) = delete;
+		MpscQueue& operator=(const MpscQueue&) = delete;
+
+		// Add the value. Return false if the queue is full.
+		// Safe to call from any thread.
+		bool push(T value);
+
+		// Move the oldest value to the argument. Return false if empty.
+		// Must only be called by the consumer thread.
+		bool pop(T& value);
+
+		int getCapacity() const {
+			return (int) (mask_ + 1);
+		}
+
+	private:
+		struct Cell {
+			std::atomic<size_t> sequence_;
+			T value_;
+		};
+
+		std::unique_ptr<Cell[]> cells_;
+		size_t mask_;
+		// On separate cache lines, producers and the consumer do not share writes.
+		alignas(64) std::atomic<size_t> enqueuePosition_;
+		alignas(64) size_t dequeuePosition_;
+	};
+
+	template <class T>
+	MpscQueue<T>::MpscQueue(int capacity) : enqueuePosition_(0), dequeuePosition_(0) {
+		size_t size = 2;
+		while (size < (size_t) capacity) {
+			size *= 2;
+		}
+		mask_ = size - 1;
+		cells_ = std::make_unique<Cell[]>(size);
+		for (size_t i = 0; i < size; ++i) {
+			cells_[i].sequence_.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	template <class T>
+	bool MpscQueue<T>::push(T value) {
+		size_t position = enqueuePosition_.load(std::memory_order_relaxed);
+		Cell* cell;
+		while (true) {
+			cell = &cells_[position & mask_];
+			size_t sequence = cell->sequence_.load(std::memory_order_acquire);
+			intptr_t difference = (intptr_t) sequence - (intptr_t) position;
+			if (difference == 0) {
+				// The cell is free, try to claim it.
+				if (enqueuePosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			} else if (difference < 0) {
+				// Not yet consumed since the last lap, i.e. full.
+				return false;
+			} else {
+				// Claimed by another producer.
+				position = enqueuePosition_.load(std::memory_order_relaxed);
+			}
+		}
+		cell->value_ = std::move(value);
+		cell->sequence_.store(position + 1, std::memory_order_release);
+		return true;
+	}
+
+	template <class T>
+	bool MpscQueue<T>::pop(T& value) {
+		Cell& cell = cells_[dequeuePosition_ & mask_];
+		size_t sequence = cell.sequence_.load(std::memory_order_acquire);
+		if (sequence != dequeuePosition_ + 1) {
+			// Empty, or the producer is not done writing.
+			return false;
+		}
+		value = std::move(cell.value_);
+		// Release what the value holds now, not when the cell is reused.
+		cell.value_ = T();
+		cell.sequence_.store(dequeuePosition_ + mask_ + 1, std::memory_order_release);
+		++dequeuePosition_;
+		return true;
+	}
+
+} // Namespace gui.
+
+#endif // GUI_MPSCQUEUE_H
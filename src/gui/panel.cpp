@@ -2,26 +2,80 @@
 #include "component.h"
 #include "flowlayout.h"
 #include "frame.h"
+#include "threadpool.h"
 
 #include <list>
 #include <cassert>
+#include <cmath>
 
 namespace gui {
 
-	Panel::Panel() : layoutManager_(std::make_shared<FlowLayout>()) {
+	namespace {
+
+		// Panels with fewer components are searched without the grid.
+		const unsigned int HIT_GRID_THRESHOLD = 16;
+
+		bool contains(const Component& component, float x, float y) {
+			Point p = component.getLocation();
+			Dimension d = component.getSize();
+			return p.x_ <= x && p.x_ + d.width_ > x && p.y_ <= y && p.y_ + d.height_ > y;
+		}
+
+		bool intersects(const Component& component, const Rect& rect) {
+			Point p = component.getLocation();
+			Dimension d = component.getSize();
+			return rect.intersects(Rect(p.x_, p.y_, d.width_, d.height_));
+		}
+
+		// Return true if the outer rectangle contains the inner rectangle.
+		bool contains(const Rect& outer, const Rect& inner) {
+			return outer.x_ <= inner.x_ && outer.y_ <= inner.y_
+				&& outer.x_ + outer.width_ >= inner.x_ + inner.width_
+				&& outer.y_ + outer.height_ >= inner.y_ + inner.height_;
+		}
+
+	}
+
+	Panel::Panel() : layoutManager_(std::make_shared<FlowLayout>()),
+		priorityComponent_(nullptr), mouseMotionInsideComponent_(nullptr),
+		mouseDownInsideComponent_(nullptr), focusedChild_(nullptr), updateDepth_(0),
+		hitGridValid_(false), parallelLayout_(false), cached_(false), unchangedFrames_(0) {
+
 		setPreferredSize(50, 50);
 		setBorderColor(1, 1, 1, 0);
 	}
 
-	void Panel::setChildsParent() {
-	    for (auto& c : components_) {
-			c->parent_ = std::static_pointer_cast<Panel>(shared_from_this());
-			if (ancestor_ != nullptr) {
-				c->ancestor_ = ancestor_;
-			} else {
-				c->ancestor_ = c->parent_;
-			}
-			c->setChildsParent();
+	Panel::~Panel() {
+		for (auto& component : components_) {
+			detachChild(*component);
+		}
+	}
+
+	void Panel::attachChild(Component& child) {
+		child.parent_ = this;
+		child.isAdded_ = true;
+		for (Component* component = this; component != nullptr; component = component->parent_) {
+			component->serialLayouts_ += child.serialLayouts_;
+		}
+	}
+
+	void Panel::detachChild(Component& child) {
+		for (Component* component = this; component != nullptr; component = component->parent_) {
+			component->serialLayouts_ -= child.serialLayouts_;
+		}
+		child.parent_ = nullptr;
+		child.isAdded_ = false;
+	}
+
+	void Panel::beginUpdate() {
+		++updateDepth_;
+	}
+
+	void Panel::endUpdate() {
+		assert(updateDepth_ > 0);
+		if (--updateDepth_ == 0) {
+			invalidate();
+			repaint();
 		}
 	}
 
@@ -34,50 +88,94 @@ namespace gui {
 		// Was already added?
 		assert(!component->isAdded_);
 		component->init();
-		component->isAdded_ = true;
 		component->setLayoutIndex(layoutIndex);
 		components_.push_back(component);
-		setChildsParent();
-		validate();
+		attachChild(*component);
+		if (component->hasFocus()) {
+			childFocusGained(*component);
+		}
+		component->updateModelMatrix();
+		component->invalidate();
+		hitGridValid_ = false;
+		if (updateDepth_ == 0) {
+			invalidate();
+		}
 		return component;
 	}
 
 	void Panel::remove(const std::shared_ptr<Component>& component) {
 		auto it = std::find(components_.begin(), components_.end(), component);
 		if (it != components_.end()) {
-			// Remove component.
+			// Remove component. Kept alive, the reference may be to the element erased.
+			std::shared_ptr<Component> removed = component;
+			forgetChild(removed.get());
+			detachChild(*removed);
 			components_.erase(it);
+			hitGridValid_ = false;
+			if (updateDepth_ == 0) {
+				invalidate();
+				repaint();
+			}
+			// Detached, i.e. the panel is not called back.
+			removed->setFocus(false);
 		}
 	}
 
 	void Panel::removeAll() {
+		std::shared_ptr<Component> focused;
+		if (focusedChild_ != nullptr) {
+			focused = focusedChild_->shared_from_this();
+		}
+		priorityComponent_ = nullptr;
+		mouseMotionInsideComponent_ = nullptr;
+		mouseDownInsideComponent_ = nullptr;
+		focusedChild_ = nullptr;
+		for (auto& component : components_) {
+			detachChild(*component);
+		}
 		components_.clear();
+		hitGridValid_ = false;
+		if (updateDepth_ == 0) {
+			invalidate();
+			repaint();
+		}
+		if (focused != nullptr) {
+			focused->setFocus(false);
+		}
 	}
 
 	std::shared_ptr<LayoutManager> Panel::setLayout(const std::shared_ptr<LayoutManager>& layoutManager) {
 		layoutManager_ = layoutManager;
+		invalidate();
+		repaint();
 		return layoutManager_;
 	}
 
 	void Panel::setFocus(bool focus) {
-		Component::setFocus(focus, shared_from_this());
-		if (!focus) { // Only takes focus away from children, not giving them focus.			
-			for (auto& component : *this) {
-				component->setFocus(false);
-			}
+		Component::setFocus(focus);
+		// Only takes focus away from children, not giving them focus.
+		if (!focus && focusedChild_ != nullptr) {
+			Component* child = focusedChild_;
+			focusedChild_ = nullptr;
+			child->setFocus(false);
 		}
 	}
 
-	void Panel::setFocus(bool focus, const std::shared_ptr<Component>& child) {
-		Component::setFocus(focus, shared_from_this());
-		if (parent_ && focus) {
-			parent_->setFocus(focus, shared_from_this());
-		}
-		for (auto& component : *this) {
-			if (child != component && focus) {
-				component->setFocus(false);
+	void Panel::childFocusGained(Component& child) {
+		if (focusedChild_ != &child) {
+			Component* previous = focusedChild_;
+			focusedChild_ = &child;
+			if (previous != nullptr) {
+				previous->setFocus(false);
 			}
 		}
+		setFocus(true);
+	}
+
+	void Panel::childFocusLost(Component& child) {
+		if (focusedChild_ == &child) {
+			focusedChild_ = nullptr;
+		}
 	}
 
 	std::shared_ptr<LayoutManager> Panel::getLayout() const {
@@ -88,46 +186,143 @@ namespace gui {
 		return components_;
 	}
 
+	void Panel::setCached(bool cached) {
+		cached_ = cached;
+		if (!cached) {
+			layer_ = nullptr;
+		}
+		repaint();
+	}
+
 	void Panel::draw(const Graphic& graphic, double deltaTime) {
-		graphic.useProgram();
+		bool modified = modified_;
+		modified_ = false;
+		if (modified) {
+			unchangedFrames_ = 0;
+		} else {
+			++unchangedFrames_;
+		}
+
+		int threshold = graphic.getCacheThreshold();
+		bool useLayer = cached_ || (threshold > 0 && unchangedFrames_ >= threshold);
+		// A recorded frame is drawn later, the layer can not be drawn in between.
+		// The layer is kept for the frames not recorded.
+		if (useLayer && !graphic.isRecording()) {
+			drawLayer(graphic, deltaTime, modified);
+		} else {
+			drawComponents(graphic, deltaTime);
+		}
+		drawPriorityComponent(graphic, deltaTime);
+	}
+
+	void Panel::drawLayer(const Graphic& graphic, double deltaTime, bool modified) {
+		Rect rect = getWindowRect();
+		int width = (int) std::ceil(rect.width_);
+		int height = (int) std::ceil(rect.height_);
+		if (width <= 0 || height <= 0) {
+			return;
+		}
+
+		bool resized = layer_ == nullptr || layer_->getWidth() != width || layer_->getHeight() != height;
+		if (resized) {
+			layer_ = std::make_unique<RenderTarget>(width, height);
+		}
+		bool moved = layerRect_.x_ != rect.x_ || layerRect_.y_ != rect.y_;
+		if (resized || moved || modified) {
+			layerRect_ = rect;
+			graphic.beginLayer(*layer_, rect);
+			drawComponents(graphic, deltaTime);
+			graphic.endLayer(*layer_);
+		}
+
+		graphic.setModel(Component::model_);
+		graphic.drawLayer(*layer_, (float) width, (float) height);
+	}
+
+	void Panel::drawComponents(const Graphic& graphic, double deltaTime) {
 		graphic.setModel(Component::model_);
 		Component::draw(graphic, deltaTime);
 
-		// Draw the components.
-		for (auto& component : *this) {
-			if (component != priorityComponent_ && component->isVisible()) {
-				graphic.useProgram();
-				graphic.setModel(component->model_);
-				component->draw(graphic, deltaTime);
+		if (!hitGridValid_) {
+			updateHitGrid();
+		}
+		Rect rect = getWindowRect();
+		// Children reaching outside the panel are clipped.
+		bool clip = !childBounds_.isEmpty() && (childBounds_.x_ < 0 || childBounds_.y_ < 0
+			|| childBounds_.x_ + childBounds_.width_ > rect.width_
+			|| childBounds_.y_ + childBounds_.height_ > rect.height_);
+		if (clip) {
+			graphic.pushClip(rect);
+		}
+
+		// Only the children inside the visible part are drawn.
+		Rect visible = graphic.getVisibleRect();
+		visible.x_ -= rect.x_;
+		visible.y_ -= rect.y_;
+		if (components_.size() >= HIT_GRID_THRESHOLD && !contains(visible, childBounds_)) {
+			hitGrid_.query(visible, visibleIndexes_);
+			for (int index : visibleIndexes_) {
+				drawChild(graphic, *components_[index], visible, deltaTime);
+			}
+		} else if (!visible.isEmpty()) {
+			for (auto& component : components_) {
+				drawChild(graphic, *component, visible, deltaTime);
 			}
 		}
 
+		if (clip) {
+			graphic.popClip();
+		}
+	}
+
+	void Panel::drawPriorityComponent(const Graphic& graphic, double deltaTime) {
+		// Drawn on top, outside the clip and the layer. The clips pushed by
+		// the parents, e.g. a scrolled list, do not apply either.
 		if (priorityComponent_) {
-			graphic.useProgram();
+			graphic.pushWindowClip();
 			graphic.setModel(priorityComponent_->model_);
 			priorityComponent_->draw(graphic, deltaTime);
+			graphic.popClip();
+		}
+	}
+
+	void Panel::drawChild(const Graphic& graphic, Component& child, const Rect& visible, double deltaTime) {
+		if (&child != priorityComponent_ && child.isVisible() && intersects(child, visible)) {
+			graphic.setModel(child.model_);
+			child.draw(graphic, deltaTime);
 		}
 	}
 
 	void Panel::handleMouse(const SDL_Event& mouseEvent) {
-		std::shared_ptr<Component> currentComponent;
+		// The position is translated in place for the children and restored
+		// afterwards, i.e. the event is not copied at each level. The events
+		// are owned by the frame, not const.
+		SDL_Event& event = const_cast<SDL_Event&>(mouseEvent);
 		switch (mouseEvent.type) {
 			case SDL_MOUSEMOTION:
-				handleMouseMotionEvent(mouseEvent);
+				handleMouseMotionEvent(event);
 				break;
 			case SDL_MOUSEBUTTONDOWN:
 				// Fall through!
 			case SDL_MOUSEBUTTONUP:
-				handleMouseButtonEvent(mouseEvent);
+				handleMouseButtonEvent(event);
+				break;
+			case SDL_MOUSEWHEEL:
+				// The wheel event has no position, use the component under the mouse.
+				if (mouseMotionInsideComponent_ != nullptr) {
+					mouseMotionInsideComponent_->handleMouse(mouseEvent);
+				}
+				Component::handleMouse(mouseEvent);
 				break;
 		}
 	}
 
 	void Panel::handleKeyboard(const SDL_Event& keyEvent) {
-		for (auto& component : *this) {
-			if (component->hasFocus()) {
-				component->handleKeyboard(keyEvent);
-			}
+		// Follow the focus path, instead of asking all children. Kept alive
+		// while the listeners are called, they may remove it.
+		if (focusedChild_ != nullptr && focusedChild_->hasFocus()) {
+			std::shared_ptr<Component> focused = focusedChild_->shared_from_this();
+			focused->handleKeyboard(keyEvent);
 		}
 		Component::handleKeyboard(keyEvent);
 	}
@@ -146,7 +341,7 @@ namespace gui {
 
 	void Panel::panelChanged(bool active) {
 		if (active) {
-			validate();
+			invalidate();
 		}
 
 		for (auto& component : *this) {
@@ -164,97 +359,216 @@ namespace gui {
 		}
 	}
 
+	void Panel::collectDirtyRegion(Rect& region, bool covered) {
+		if (!isDirty() && !descendantDirty_) {
+			return;
+		}
+		// A dirty panel covers all children.
+		bool childsCovered = covered || isDirty() || !isVisible();
+		Component::collectDirtyRegion(region, covered);
+		for (auto& child : *this) {
+			child->collectDirtyRegion(region, childsCovered);
+		}
+	}
+
 	void Panel::validate() {
 		// Validate!
+		repaint();
+		hitGridValid_ = false;
 		layoutManager_->layoutContainer(*this);
+	}
+
+	void Panel::layout() {
+		if (layoutDirty_) {
+			layoutDirty_ = false;
+			validate();
+		}
+		// Children resized by the layout manager are marked and laid out in the same pass.
+		if (descendantLayoutDirty_) {
+			if (parallelLayout_) {
+				layoutChildrenInParallel();
+			} else {
+				for (auto& child : *this) {
+					if (child->layoutDirty_ || child->descendantLayoutDirty_) {
+						child->layout();
+					}
+				}
+			}
+			descendantLayoutDirty_ = false;
+		}
+	}
+
+	void Panel::layoutChildrenInParallel() {
+		subtreeLayouts_.clear();
 		for (auto& child : *this) {
-			child->validate();
+			if (child->layoutDirty_ || child->descendantLayoutDirty_) {
+				if (child->serialLayouts_ > 0) {
+					// E.g. a ListView calling user code, laid out before the pool starts.
+					child->layout();
+				} else {
+					subtreeLayouts_.push_back(SubtreeLayout{child.get(), false, false, false, false});
+				}
+			}
+		}
+
+		ThreadPool::getInstance().run((int) subtreeLayouts_.size(), [&](int index) {
+			// The thread may be inside another subtree, when waiting for a nested pass.
+			SubtreeLayout* previous = subtreeLayout_;
+			subtreeLayout_ = &subtreeLayouts_[index];
+			subtreeLayout_->root_->layout();
+			subtreeLayout_ = previous;
+		});
+
+		// The changes only set flags, the order between the subtrees does not matter.
+		// The path above the panel is already marked for layout, invalidate() stops
+		// below it and never reaches the shared ancestors.
+		for (SubtreeLayout& subtree : subtreeLayouts_) {
+			if (subtree.repaintAncestors_) {
+				subtree.root_->repaintAncestors();
+			}
+			if (subtree.repaintParent_) {
+				repaint();
+			}
+			if (subtree.validateParent_) {
+				invalidate();
+			}
+			if (subtree.invalidateHitGrid_) {
+				hitGridValid_ = false;
+			}
 		}
 	}
 
-	void Panel::handleMouseMotionEvent(SDL_Event mouseEvent) {
-		std::shared_ptr<Component> currentComponent = priorityComponent_;
-		unsigned int index = 0;
-		while (index < components_.size()) {
-			if (currentComponent == nullptr) {
-				currentComponent = components_[index];
-				++index;
+	void Panel::updateModelMatrix() {
+		const float* m = model_.data();
+		float x = m[12];
+		float y = m[13];
+		Component::updateModelMatrix();
+		// Children are placed relative to the panel.
+		if (x != m[12] || y != m[13]) {
+			for (auto& child : *this) {
+				child->updateModelMatrix();
 			}
-			if (!currentComponent->isVisible()) {
-				++index;
-				continue;
+		}
+	}
+
+	Component* Panel::getComponentAt(float x, float y) {
+		if (priorityComponent_ != nullptr && priorityComponent_->isVisible() && contains(*priorityComponent_, x, y)) {
+			return priorityComponent_;
+		}
+
+		if (components_.size() < HIT_GRID_THRESHOLD) {
+			for (auto& component : components_) {
+				if (component->isVisible() && contains(*component, x, y)) {
+					return component.get();
+				}
 			}
-			Point p = currentComponent->getLocation();
-			Dimension d = currentComponent->getSize();
-			if (p.x_ <= mouseEvent.motion.x && p.x_ + d.width_ > mouseEvent.motion.x &&
-				p.y_ <= mouseEvent.motion.y && p.y_ + d.height_ > mouseEvent.motion.y) {
-				SDL_Event motionEvent = mouseEvent;
-				motionEvent.motion.x -= (Sint32) p.x_;
-				motionEvent.motion.y -= (Sint32) p.y_;
-				currentComponent->handleMouse(motionEvent);
-				break;
+			return nullptr;
+		}
+
+		if (!hitGridValid_) {
+			updateHitGrid();
+		}
+		for (int index : hitGrid_.query(x, y)) {
+			Component* component = components_[index].get();
+			if (component->isVisible() && contains(*component, x, y)) {
+				return component;
 			}
-			currentComponent = nullptr;
+		}
+		return nullptr;
+	}
+
+	void Panel::updateHitGrid() {
+		Rect bounds;
+		for (auto& component : components_) {
+			Point p = component->getLocation();
+			Dimension d = component->getSize();
+			bounds = bounds.unite(Rect(p.x_, p.y_, d.width_, d.height_));
+		}
+
+		childBounds_ = bounds;
+		hitGrid_.clear(bounds, components_.size());
+		int index = 0;
+		for (auto& component : components_) {
+			Point p = component->getLocation();
+			Dimension d = component->getSize();
+			hitGrid_.insert(index++, Rect(p.x_, p.y_, d.width_, d.height_));
+		}
+		hitGridValid_ = true;
+	}
+
+	void Panel::forgetChild(const Component* child) {
+		if (priorityComponent_ == child) {
+			priorityComponent_ = nullptr;
+		}
+		if (mouseMotionInsideComponent_ == child) {
+			mouseMotionInsideComponent_ = nullptr;
+		}
+		if (mouseDownInsideComponent_ == child) {
+			mouseDownInsideComponent_ = nullptr;
+		}
+		if (focusedChild_ == child) {
+			focusedChild_ = nullptr;
+		}
+	}
+
+	void Panel::handleMouseMotionEvent(SDL_Event& mouseEvent) {
+		// Kept alive while the listeners are called, they may remove it.
+		std::shared_ptr<Component> currentComponent;
+		if (Component* component = getComponentAt((float) mouseEvent.motion.x, (float) mouseEvent.motion.y)) {
+			currentComponent = component->shared_from_this();
+		}
+		if (currentComponent != nullptr) {
+			Point p = currentComponent->getLocation();
+			mouseEvent.motion.x -= (Sint32) p.x_;
+			mouseEvent.motion.y -= (Sint32) p.y_;
+			currentComponent->handleMouse(mouseEvent);
+			mouseEvent.motion.x += (Sint32) p.x_;
+			mouseEvent.motion.y += (Sint32) p.y_;
 		}
 
-		if (mouseMotionInsideComponent_ != nullptr && mouseMotionInsideComponent_ != currentComponent) {
+		if (mouseMotionInsideComponent_ != nullptr && mouseMotionInsideComponent_ != currentComponent.get()) {
 			mouseMotionInsideComponent_->mouseMotionLeave();
 		}
 
-		mouseMotionInsideComponent_ = currentComponent;
+		mouseMotionInsideComponent_ = getChild(currentComponent);
 		Component::handleMouse(mouseEvent);
 	}
 
-	void Panel::handleMouseButtonEvent(SDL_Event mouseEvent) {
-		std::shared_ptr<Component> currentComponent = priorityComponent_;
-		unsigned int index = 0;
-		// Send the mouseEvent through to the correct component.
-		while (index < components_.size()) {
-			if (currentComponent == nullptr) {
-				currentComponent = components_[index];
-				++index;
-			}
-			if (!currentComponent->isVisible()) {
-				++index;
-				continue;
-			}
+	void Panel::handleMouseButtonEvent(SDL_Event& mouseEvent) {
+		// Send the mouseEvent through to the correct component. Kept alive
+		// while the listeners are called, they may remove it.
+		std::shared_ptr<Component> currentComponent;
+		if (Component* component = getComponentAt((float) mouseEvent.button.x, (float) mouseEvent.button.y)) {
+			currentComponent = component->shared_from_this();
+		}
+		if (currentComponent != nullptr) {
 			Point p = currentComponent->getLocation();
-			Dimension d = currentComponent->getSize();
-			if (p.x_ <= mouseEvent.button.x && p.x_ + d.width_ > mouseEvent.button.x &&
-				p.y_ <= mouseEvent.button.y && p.y_ + d.height_ > mouseEvent.button.y) {
-				SDL_Event buttonEvent = mouseEvent;
-				buttonEvent.button.x -= (Sint32) p.x_;
-				buttonEvent.button.y -= (Sint32) p.y_;
-				currentComponent->handleMouse(buttonEvent);
-				break; // Abort, components should not overlap!
-			}
-			currentComponent = nullptr;
+			mouseEvent.button.x -= (Sint32) p.x_;
+			mouseEvent.button.y -= (Sint32) p.y_;
+			currentComponent->handleMouse(mouseEvent);
+			mouseEvent.button.x += (Sint32) p.x_;
+			mouseEvent.button.y += (Sint32) p.y_;
 		}
 
 		if (mouseEvent.type == SDL_MOUSEBUTTONDOWN) {
-			// Set all components focus to false except
-			// the component used.
-			for (auto& component : *this) {
-				if (!component->isVisible()) {
-					continue;
-				}
-				if (currentComponent == component) {
-					component->setFocus(true);
-				} else {
-					component->setFocus(false);
-				}
+			// The component used gets the focus, the previously focused loses it.
+			// Not given to a component removed by a listener.
+			if (Component* component = getChild(currentComponent)) {
+				component->setFocus(true);
+			} else if (focusedChild_ != nullptr) {
+				focusedChild_->setFocus(false);
 			}
 		}
 
 		// Call the component if it was pushed and released outside
 		// the component.
 		if (mouseEvent.type == SDL_MOUSEBUTTONUP) {
-			if (mouseDownInsideComponent_ != nullptr && mouseDownInsideComponent_ != currentComponent) {
+			if (mouseDownInsideComponent_ != nullptr && mouseDownInsideComponent_ != currentComponent.get()) {
 				mouseDownInsideComponent_->mouseOutsideUp();
 				mouseDownInsideComponent_ = nullptr;
 			}
 		} else if (mouseEvent.type == SDL_MOUSEBUTTONDOWN) {
-			mouseDownInsideComponent_ = currentComponent;
+			mouseDownInsideComponent_ = getChild(currentComponent);
 		}
 
 		Component::handleMouse(mouseEvent);
@@ -265,13 +579,13 @@ namespace gui {
 			priorityComponent_->priorityChanged(false);
 		}
 		if (component != nullptr) {
-			priorityComponent_ = component;
+			priorityComponent_ = component.get();
 			priorityComponent_->priorityChanged(true);
 		}
 	}
 
 	void Panel::releasePriority(const std::shared_ptr<Component>& component) {
-		if (priorityComponent_ != nullptr && component == priorityComponent_) {
+		if (priorityComponent_ != nullptr && component.get() == priorityComponent_) {
 			priorityComponent_->priorityChanged(false);
 			priorityComponent_ = nullptr;
 		}
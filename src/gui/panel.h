@@ -3,8 +3,12 @@
 
 #include "component.h"
 #include "layoutmanager.h"
+#include "rendertarget.h"
+#include "spatialgrid.h"
 
+#include <memory>
 #include <vector>
+#include <iterator>
 
 namespace gui {
 
@@ -18,10 +22,27 @@ namespace gui {
 		using const_iterator = std::vector<std::shared_ptr<Component>>::const_iterator;
 
 		friend class Frame;
+		friend class Component;
+
+		// Groups changes to the panel's children. The layout and repaint of the
+		// panel is requested once, when the last guard is destroyed.
+		class BatchUpdate {
+		public:
+			explicit BatchUpdate(Panel& panel);
+			~BatchUpdate();
+
+			BatchUpdate(const BatchUpdate&) = delete;
+			BatchUpdate& operator=(const BatchUpdate&) = delete;
+
+		private:
+			Panel& panel_;
+		};
 
 		// Create a empty panel. The default LayoutManager is FlowLayout.
 		Panel();
-		virtual ~Panel() = default;
+
+		// The children kept alive elsewhere are detached from the panel.
+		virtual ~Panel();
 
 		// Add the component, with the provided layoutIndex.
 		// Will assert if the component already added.
@@ -43,6 +64,15 @@ namespace gui {
 		template <class Comp, class... Args>
 		std::shared_ptr<Comp> add(int layoutIndex, Args... args);
 
+		// Add all components in the range [first, last), with the provided
+		// layoutIndex. The layout is done once for all components.
+		// Will assert if a component already added.
+		template <class Iterator>
+		void addAll(Iterator first, Iterator last, int layoutIndex = DEFAULT_INDEX);
+
+		template <class Range>
+		void addAll(const Range& components, int layoutIndex = DEFAULT_INDEX);
+
 		void remove(const std::shared_ptr<Component>& component);
 		void removeAll();
 
@@ -76,13 +106,40 @@ namespace gui {
 
 		void releasePriority(const std::shared_ptr<Component>& component);
 
+		// Lay out the children now, using the layout manager. Children which
+		// change size are laid out before the next draw.
 		void validate() override;
 
-	protected:
-		// @Component Make the focus propagete upwards, from child to parent.
-		void setFocus(bool focus, const std::shared_ptr<Component>& child) override;
+		// Draw the panel and its children to a cached texture, which is drawn
+		// again until something inside the panel is repainted. Best suited for
+		// static panels with many children and a opaque background. The
+		// priority component is drawn on top of the texture. Frames recorded
+		// to a draw list do not use the texture, the panel is drawn directly.
+		// Default is false.
+		void setCached(bool cached);
+
+		bool isCached() const {
+			return cached_;
+		}
+
+		// Lay out the children marked by invalidate() in parallel, on the
+		// shared ThreadPool. The positions and sizes are the same as when laid
+		// out one after another. Only for children independent of each other,
+		// i.e. their layout must not change their siblings. Subtrees containing
+		// a component calling Component::setSerialLayout(), e.g. a ListView,
+		// are laid out on the calling thread. Default is false.
+		void setParallelLayout(bool parallel) {
+			parallelLayout_ = parallel;
+		}
+
+		bool isParallelLayout() const {
+			return parallelLayout_;
+		}
 
-		void setChildsParent() override;
+	protected:
+		Component* getFocusedChild() const override {
+			return focusedChild_;
+		}
 
 		virtual void draw(const Graphic& graphic, double deltaTime) override;
 
@@ -98,17 +155,88 @@ namespace gui {
 
 		void drawListener(Frame& frame, double deltaTime) override final;
 
+		void collectDirtyRegion(Rect& region, bool covered) override;
+
+		void layout() override;
+
+		void updateModelMatrix() override;
+
 	private:
-		void handleMouseMotionEvent(SDL_Event mouseEvent);
+		// Make the panel the child's parent. The child's own children
+		// are already linked to the child, i.e. are left untouched.
+		void attachChild(Component& child);
+
+		// Clear the child's link to the panel, the child can be added again.
+		void detachChild(Component& child);
+
+		void beginUpdate();
+
+		void endUpdate();
+
+		void handleMouseMotionEvent(SDL_Event& mouseEvent);
+
+		void handleMouseButtonEvent(SDL_Event& mouseEvent);
+
+		// Return the visible component at the point, in the panel's coordinate
+		// space. Return null if no component is found.
+		Component* getComponentAt(float x, float y);
+
+		// Update the hit grid and the children's bounds.
+		void updateHitGrid();
+
+		// Clear the raw pointers to the child, about to be removed.
+		void forgetChild(const Component* child);
 
-		void handleMouseButtonEvent(SDL_Event mouseEvent);
+		// Return the component if still a child, else null. I.e. not removed
+		// by a listener.
+		Component* getChild(const std::shared_ptr<Component>& component) const {
+			return component != nullptr && component->parent_ == this ? component.get() : nullptr;
+		}
+
+		// The child is on the focus path, i.e. the panel gets the focus and
+		// the previously focused child loses it.
+		void childFocusGained(Component& child);
+
+		void childFocusLost(Component& child);
+
+		// Draw the panel and the children, except the priority component.
+		void drawComponents(const Graphic& graphic, double deltaTime);
+
+		void drawPriorityComponent(const Graphic& graphic, double deltaTime);
+
+		// Draw the child if visible and inside the visible rectangle, in the
+		// panel's coordinate space.
+		void drawChild(const Graphic& graphic, Component& child, const Rect& visible, double deltaTime);
+
+		void drawLayer(const Graphic& graphic, double deltaTime, bool modified);
+
+		// Lay out the marked children, each subtree by one pool thread.
+		void layoutChildrenInParallel();
 
 		std::vector<std::shared_ptr<Component>> components_;
-		std::shared_ptr<Component> priorityComponent_;
 		std::shared_ptr<LayoutManager> layoutManager_;
 
-		std::shared_ptr<Component> mouseMotionInsideComponent_;
-		std::shared_ptr<Component> mouseDownInsideComponent_;
+		// Children owned by components_, raw to avoid reference counting
+		// when handling events and drawing. Cleared when the child is removed.
+		Component* priorityComponent_;
+		Component* mouseMotionInsideComponent_;
+		Component* mouseDownInsideComponent_;
+		Component* focusedChild_; // Receives the keyboard events.
+
+		int updateDepth_;
+
+		SpatialGrid hitGrid_;
+		Rect childBounds_; // Smallest rectangle containing all children.
+		bool hitGridValid_;
+		std::vector<int> visibleIndexes_; // Used when drawing.
+
+		bool parallelLayout_;
+		std::vector<SubtreeLayout> subtreeLayouts_; // Used by layoutChildrenInParallel().
+
+		bool cached_;
+		int unchangedFrames_;
+		std::unique_ptr<RenderTarget> layer_;
+		Rect layerRect_;
 	};
 
 	template <class LManager, class... Args>
@@ -132,6 +260,28 @@ namespace gui {
 		return c;
 	}
 
+	template <class Iterator>
+	void Panel::addAll(Iterator first, Iterator last, int layoutIndex) {
+		BatchUpdate batchUpdate(*this);
+		for (; first != last; ++first) {
+			add(layoutIndex, *first);
+		}
+	}
+
+	template <class Range>
+	void Panel::addAll(const Range& components, int layoutIndex) {
+		components_.reserve(components_.size() + components.size());
+		addAll(std::begin(components), std::end(components), layoutIndex);
+	}
+
+	inline Panel::BatchUpdate::BatchUpdate(Panel& panel) : panel_(panel) {
+		panel_.beginUpdate();
+	}
+
+	inline Panel::BatchUpdate::~BatchUpdate() {
+		panel_.endUpdate();
+	}
+
 	inline int Panel::getComponentsCount() const {
 		return components_.size();
 	}
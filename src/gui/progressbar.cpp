@@ -26,6 +26,9 @@ namespace gui {
 		// Draw moving bar inside the 1 pixel border.
 		graphic.setColor(barColor_);
 		graphic.drawSquare(xPostion_, 1, barWidth_, dim.height_ - 2);
+
+		// Keep the animation going.
+		repaint();
 	}
 
 } // Namespace gui.
@@ -22,6 +22,7 @@ namespace gui {
 		// Set the color for the moving bar.
 		void setBarColor(const mw::Color& color) {
 			barColor_ = color;
+			repaint();
 		}
 
 		// Set the color for the moving bar.
@@ -31,6 +32,7 @@ namespace gui {
 
 		void setBarWidth(float width) {
 			barWidth_ = width;
+			repaint();
 		}
 
 		float getBarWidth() const {
@@ -39,6 +41,7 @@ namespace gui {
 
 		void setBarSpeed(float speed) {
 			barSpeed_ = speed;
+			repaint();
 		}
 
 		float getBarSpeed() const {
@@ -0,0 +1,33 @@
+#include "recttransform.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define GUI_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace gui {
+
+	void transformRects(float* rects, int count, float scaleX, float scaleY, float x, float y) {
+		int i = 0;
+#ifdef GUI_USE_SSE
+		// One rectangle fills one register.
+		const __m128 scale = _mm_setr_ps(scaleX, scaleY, scaleX, scaleY);
+		const __m128 translate = _mm_setr_ps(x, y, 0, 0);
+		for (; i + 1 < count; i += 2) {
+			float* rect = rects + i * 4;
+			__m128 a = _mm_loadu_ps(rect);
+			__m128 b = _mm_loadu_ps(rect + 4);
+			_mm_storeu_ps(rect, _mm_add_ps(_mm_mul_ps(a, scale), translate));
+			_mm_storeu_ps(rect + 4, _mm_add_ps(_mm_mul_ps(b, scale), translate));
+		}
+#endif
+		for (; i < count; ++i) {
+			float* rect = rects + i * 4;
+			rect[0] = rect[0] * scaleX + x;
+			rect[1] = rect[1] * scaleY + y;
+			rect[2] *= scaleX;
+			rect[3] *= scaleY;
+		}
+	}
+
+} // Namespace gui.
@@ -0,0 +1,13 @@
+#ifndef GUI_RECTTRANSFORM_H
+#define GUI_RECTTRANSFORM_H
+
+namespace gui {
+
+	// Transform the rectangles, stored as (x, y, width, height), in place.
+	// The position is scaled and then translated, and the size is scaled.
+	// Uses SSE when available.
+	void transformRects(float* rects, int count, float scaleX, float scaleY, float x, float y);
+
+} // Namespace gui.
+
+#endif // GUI_RECTTRANSFORM_H
@@ -0,0 +1,41 @@
+#include "rendertarget.h"
+
+namespace gui {
+
+	RenderTarget::RenderTarget(int width, int height) : frameBuffer_(0), texture_(0),
+		width_(width), height_(height), previousFrameBuffer_(0), previousViewport_{0, 0, 0, 0} {
+
+		glGenTextures(1, &texture_);
+		glBindTexture(GL_TEXTURE_2D, texture_);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+		glGenFramebuffers(1, &frameBuffer_);
+		GLint previous = 0;
+		glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous);
+		glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer_);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture_, 0);
+		glBindFramebuffer(GL_FRAMEBUFFER, previous);
+	}
+
+	RenderTarget::~RenderTarget() {
+		glDeleteFramebuffers(1, &frameBuffer_);
+		glDeleteTextures(1, &texture_);
+	}
+
+	void RenderTarget::bind() {
+		glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFrameBuffer_);
+		glGetIntegerv(GL_VIEWPORT, previousViewport_);
+		glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer_);
+		glViewport(0, 0, width_, height_);
+	}
+
+	void RenderTarget::unbind() {
+		glBindFramebuffer(GL_FRAMEBUFFER, previousFrameBuffer_);
+		glViewport(previousViewport_[0], previousViewport_[1], previousViewport_[2], previousViewport_[3]);
+	}
+
+} // Namespace gui.
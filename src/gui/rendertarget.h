@@ -0,0 +1,47 @@
+#ifndef GUI_RENDERTARGET_H
+#define GUI_RENDERTARGET_H
+
+#include <mw/opengl.h>
+
+namespace gui {
+
+	// A texture which can be drawn to, using a OpenGL frame buffer object.
+	class RenderTarget {
+	public:
+		RenderTarget(int width, int height);
+
+		~RenderTarget();
+
+		RenderTarget(const RenderTarget&) = delete;
+		RenderTarget& operator=(const RenderTarget&) = delete;
+
+		// Draw to the texture until unbind() is called. The previous
+		// frame buffer and viewport are restored by unbind().
+		void bind();
+
+		void unbind();
+
+		GLuint getTexture() const {
+			return texture_;
+		}
+
+		int getWidth() const {
+			return width_;
+		}
+
+		int getHeight() const {
+			return height_;
+		}
+
+	private:
+		GLuint frameBuffer_;
+		GLuint texture_;
+		int width_, height_;
+
+		GLint previousFrameBuffer_;
+		GLint previousViewport_[4];
+	};
+
+} // Namespace gui.
+
+#endif // GUI_RENDERTARGET_H
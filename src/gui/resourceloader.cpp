@@ -0,0 +1,140 @@
+#include "resourceloader.h"
+
+#include <SDL_image.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+namespace gui {
+
+	ResourceLoader::ResourceLoader(int threads) : threadCount_(threads), pending_(0), quit_(false) {
+		if (threadCount_ <= 0) {
+			threadCount_ = std::max(1, (int) std::thread::hardware_concurrency() - 1);
+		}
+	}
+
+	ResourceLoader::~ResourceLoader() {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			quit_ = true;
+		}
+		condition_.notify_all();
+		for (auto& thread : threads_) {
+			thread.join();
+		}
+		for (Task& task : loaded_) {
+			if (task.surface_ != nullptr) {
+				SDL_FreeSurface(task.surface_);
+			}
+		}
+	}
+
+	void ResourceLoader::loadSprite(const std::string& file, const SpriteCallback& callback) {
+		add(Task{file, 0, callback, nullptr, nullptr});
+	}
+
+	void ResourceLoader::loadFont(const std::string& file, int characterSize, const FontCallback& callback) {
+		add(Task{file, characterSize, nullptr, callback, nullptr});
+	}
+
+	void ResourceLoader::add(const Task& task) {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			// The workers are started by the first task.
+			while ((int) threads_.size() < threadCount_) {
+				threads_.emplace_back(&ResourceLoader::work, this);
+			}
+			tasks_.push_back(task);
+			++pending_;
+		}
+		condition_.notify_one();
+	}
+
+	void ResourceLoader::work() {
+		while (true) {
+			Task task;
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				condition_.wait(lock, [&]() {
+					return quit_ || !tasks_.empty();
+				});
+				if (quit_) {
+					return;
+				}
+				task = tasks_.front();
+				tasks_.pop_front();
+			}
+
+			if (task.spriteCallback_) {
+				task.surface_ = IMG_Load(task.file_.c_str());
+			} else {
+				// Read the file, the font is later opened from the file cache.
+				std::ifstream file(task.file_, std::ios::binary);
+				std::vector<char> buffer(1 << 16);
+				while (file.read(buffer.data(), buffer.size())) {
+				}
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				loaded_.push_back(task);
+			}
+			loadedCondition_.notify_one();
+		}
+	}
+
+	void ResourceLoader::update(double budget) {
+		auto start = std::chrono::high_resolution_clock::now();
+		do {
+			Task task;
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				if (loaded_.empty()) {
+					return;
+				}
+				task = loaded_.front();
+				loaded_.pop_front();
+				--pending_;
+			}
+			deliver(task);
+		} while (std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count() < budget);
+	}
+
+	void ResourceLoader::finish() {
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				loadedCondition_.wait(lock, [&]() {
+					return pending_ == 0 || !loaded_.empty();
+				});
+				if (pending_ == 0) {
+					return;
+				}
+			}
+			update(0);
+		}
+	}
+
+	int ResourceLoader::getPendingCount() const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return pending_;
+	}
+
+	void ResourceLoader::deliver(Task& task) {
+		if (task.spriteCallback_) {
+			if (task.surface_ == nullptr) {
+				task.spriteCallback_(mw::Sprite());
+				return;
+			}
+			// The texture takes the ownership of the surface.
+			mw::Texture texture(task.surface_);
+			// Upload now, instead of when first drawn.
+			texture.bindTexture();
+			task.spriteCallback_(mw::Sprite(texture));
+		} else {
+			task.fontCallback_(mw::Font(task.file_, task.characterSize_));
+		}
+	}
+
+} // Namespace gui.
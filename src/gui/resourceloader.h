@@ -0,0 +1,88 @@
+#ifndef GUI_RESOURCELOADER_H
+#define GUI_RESOURCELOADER_H
+
+#include <mw/sprite.h>
+#include <mw/font.h>
+
+#include <SDL.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gui {
+
+	// Loads sprites and fonts in the background. Images are decoded and
+	// font files are read by worker threads. The textures and fonts are
+	// created on the OpenGL thread by update(), using at most a time budget
+	// for each call, and are then given to the callbacks. Until then the
+	// widgets keep their empty sprites and fonts, and draw nothing in place
+	// of them.
+	class ResourceLoader {
+	public:
+		using SpriteCallback = std::function<void(const mw::Sprite&)>;
+		using FontCallback = std::function<void(const mw::Font&)>;
+
+		// Create a loader using the number of worker threads. Zero means
+		// one thread less than the number of cores, at least one.
+		explicit ResourceLoader(int threads = 0);
+
+		~ResourceLoader();
+
+		ResourceLoader(const ResourceLoader&) = delete;
+		ResourceLoader& operator=(const ResourceLoader&) = delete;
+
+		// Load the image file. The callback gets a empty sprite if the
+		// image could not be loaded.
+		void loadSprite(const std::string& file, const SpriteCallback& callback);
+
+		// Load the font file. SDL_ttf is not thread safe, the font is
+		// therefore only read into the file cache by the worker.
+		void loadFont(const std::string& file, int characterSize, const FontCallback& callback);
+
+		// Create the loaded resources and call their callbacks, until the
+		// time budget in seconds is used. At least one resource is created
+		// if any is loaded. Must be called by the OpenGL thread.
+		void update(double budget);
+
+		// Wait until all resources are loaded, and create them.
+		// Must be called by the OpenGL thread.
+		void finish();
+
+		// Return the number of resources not yet given to the callbacks.
+		int getPendingCount() const;
+
+	private:
+		struct Task {
+			std::string file_;
+			int characterSize_;
+			SpriteCallback spriteCallback_;
+			FontCallback fontCallback_;
+			SDL_Surface* surface_;
+		};
+
+		void add(const Task& task);
+
+		void work();
+
+		// Create the resource and call the callback.
+		void deliver(Task& task);
+
+		int threadCount_;
+		std::vector<std::thread> threads_;
+		mutable std::mutex mutex_;
+		std::condition_variable condition_;
+		std::condition_variable loadedCondition_;
+		std::deque<Task> tasks_; // Waiting for a worker.
+		std::deque<Task> loaded_; // Waiting for update().
+		int pending_;
+		bool quit_;
+	};
+
+} // Namespace gui.
+
+#endif // GUI_RESOURCELOADER_H
@@ -0,0 +1,80 @@
+#include "spatialgrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace gui {
+
+	namespace {
+
+		const int MAX_CELLS = 4096;
+
+	}
+
+	SpatialGrid::SpatialGrid() : columns_(0), rows_(0) {
+	}
+
+	void SpatialGrid::clear(const Rect& bounds, int size) {
+		bounds_ = bounds;
+
+		// About one rectangle per cell, with square cells.
+		int cells = std::min(std::max(size, 1), MAX_CELLS);
+		float ratio = bounds.height_ > 0 ? bounds.width_ / bounds.height_ : 1.f;
+		columns_ = std::max(1, std::min(cells, (int) std::round(std::sqrt(cells * ratio))));
+		rows_ = std::max(1, cells / columns_);
+
+		cells_.resize(columns_ * rows_);
+		for (auto& cell : cells_) {
+			cell.clear();
+		}
+	}
+
+	void SpatialGrid::insert(int index, const Rect& rect) {
+		if (rect.isEmpty() || !rect.intersects(bounds_)) {
+			return;
+		}
+		int column2 = getColumn(rect.x_ + rect.width_);
+		int row2 = getRow(rect.y_ + rect.height_);
+		for (int row = getRow(rect.y_); row <= row2; ++row) {
+			for (int column = getColumn(rect.x_); column <= column2; ++column) {
+				cells_[row * columns_ + column].push_back(index);
+			}
+		}
+	}
+
+	const std::vector<int>& SpatialGrid::query(float x, float y) const {
+		if (cells_.empty() || !bounds_.contains(x, y)) {
+			return empty_;
+		}
+		return cells_[getRow(y) * columns_ + getColumn(x)];
+	}
+
+	void SpatialGrid::query(const Rect& rect, std::vector<int>& indexes) const {
+		indexes.clear();
+		if (cells_.empty() || rect.isEmpty() || !rect.intersects(bounds_)) {
+			return;
+		}
+		int column2 = getColumn(rect.x_ + rect.width_);
+		int row2 = getRow(rect.y_ + rect.height_);
+		for (int row = getRow(rect.y_); row <= row2; ++row) {
+			for (int column = getColumn(rect.x_); column <= column2; ++column) {
+				const std::vector<int>& cell = cells_[row * columns_ + column];
+				indexes.insert(indexes.end(), cell.begin(), cell.end());
+			}
+		}
+		// Rectangles covering several cells are found more than once.
+		std::sort(indexes.begin(), indexes.end());
+		indexes.erase(std::unique(indexes.begin(), indexes.end()), indexes.end());
+	}
+
+	int SpatialGrid::getColumn(float x) const {
+		int column = (int) ((x - bounds_.x_) / bounds_.width_ * columns_);
+		return std::min(std::max(column, 0), columns_ - 1);
+	}
+
+	int SpatialGrid::getRow(float y) const {
+		int row = (int) ((y - bounds_.y_) / bounds_.height_ * rows_);
+		return std::min(std::max(row, 0), rows_ - 1);
+	}
+
+} // Namespace gui.
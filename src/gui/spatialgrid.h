@@ -0,0 +1,43 @@
+#ifndef GUI_SPATIALGRID_H
+#define GUI_SPATIALGRID_H
+
+#include "dimension.h"
+
+#include <vector>
+
+namespace gui {
+
+	// A uniform grid of cells over indexed rectangles. Used to find the
+	// rectangles at a point, or in a area, without testing all rectangles.
+	class SpatialGrid {
+	public:
+		SpatialGrid();
+
+		// Remove all rectangles and prepare the grid for the number of
+		// rectangles inside the bounds.
+		void clear(const Rect& bounds, int size);
+
+		// Insert the rectangle. Must be inserted in increasing index order.
+		void insert(int index, const Rect& rect);
+
+		// Return, in increasing order, the indexes of the rectangles sharing a
+		// cell with the point. Not all of them necessarily contains the point.
+		const std::vector<int>& query(float x, float y) const;
+
+		// Set the indexes, in increasing order and without duplicates, of the
+		// rectangles sharing a cell with the rectangle.
+		void query(const Rect& rect, std::vector<int>& indexes) const;
+
+	private:
+		int getColumn(float x) const;
+		int getRow(float y) const;
+
+		Rect bounds_;
+		int columns_, rows_;
+		std::vector<std::vector<int>> cells_;
+		std::vector<int> empty_;
+	};
+
+} // Namespace gui.
+
+#endif // GUI_SPATIALGRID_H
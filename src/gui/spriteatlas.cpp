@@ -0,0 +1,208 @@
+#include "spriteatlas.h"
+
+#include <SDL_image.h>
+
+#include <algorithm>
+
+namespace gui {
+
+	namespace {
+
+		// Empty space around each image, avoids bleeding between images
+		// when the texture is filtered.
+		const int PADDING = 1;
+
+		// Skyline bottom left packer. The skyline is the top edge of the
+		// packed images, seen from the bottom of the page.
+		class Skyline {
+		public:
+			Skyline(int width, int height) : width_(width), height_(height) {
+				nodes_.push_back(Node{0, 0, width});
+			}
+
+			// Find a place for the rectangle, as low as possible.
+			// Return false if the rectangle does not fit.
+			bool insert(int width, int height, int& x, int& y) {
+				int bestIndex = -1;
+				int bestTop = height_ + 1;
+				int bestWidth = width_ + 1;
+				for (unsigned int i = 0; i < nodes_.size(); ++i) {
+					int top;
+					if (fit(i, width, height, top)) {
+						if (top + height < bestTop || (top + height == bestTop && nodes_[i].width_ < bestWidth)) {
+							bestIndex = i;
+							bestTop = top + height;
+							bestWidth = nodes_[i].width_;
+							x = nodes_[i].x_;
+							y = top;
+						}
+					}
+				}
+				if (bestIndex < 0) {
+					return false;
+				}
+				add(bestIndex, x, y + height, width);
+				return true;
+			}
+
+		private:
+			struct Node {
+				int x_, y_;
+				int width_;
+			};
+
+			// Return true if the rectangle fits with the left edge at the node.
+			bool fit(int index, int width, int height, int& top) const {
+				int x = nodes_[index].x_;
+				if (x + width > width_) {
+					return false;
+				}
+				top = 0;
+				int left = width;
+				for (unsigned int i = index; left > 0; ++i) {
+					top = std::max(top, nodes_[i].y_);
+					if (top + height > height_) {
+						return false;
+					}
+					left -= nodes_[i].width_;
+				}
+				return true;
+			}
+
+			void add(int index, int x, int y, int width) {
+				nodes_.insert(nodes_.begin() + index, Node{x, y, width});
+
+				// Shrink or remove the nodes covered by the new node.
+				for (unsigned int i = index + 1; i < nodes_.size(); ++i) {
+					Node& previous = nodes_[i - 1];
+					Node& node = nodes_[i];
+					int shrink = previous.x_ + previous.width_ - node.x_;
+					if (shrink <= 0) {
+						break;
+					}
+					node.x_ += shrink;
+					node.width_ -= shrink;
+					if (node.width_ > 0) {
+						break;
+					}
+					nodes_.erase(nodes_.begin() + i);
+					--i;
+				}
+
+				// Merge neighbours at the same height.
+				for (unsigned int i = 0; i + 1 < nodes_.size(); ++i) {
+					if (nodes_[i].y_ == nodes_[i + 1].y_) {
+						nodes_[i].width_ += nodes_[i + 1].width_;
+						nodes_.erase(nodes_.begin() + i + 1);
+						--i;
+					}
+				}
+			}
+
+			int width_, height_;
+			std::vector<Node> nodes_;
+		};
+
+	}
+
+	SpriteAtlas::SpriteAtlas(int pageWidth, int pageHeight) : pageWidth_(pageWidth), pageHeight_(pageHeight) {
+	}
+
+	SpriteAtlas::~SpriteAtlas() {
+		for (Image& image : pending_) {
+			SDL_FreeSurface(image.surface_);
+		}
+	}
+
+	bool SpriteAtlas::add(const std::string& file) {
+		return add(file, IMG_Load(file.c_str()));
+	}
+
+	bool SpriteAtlas::add(const std::string& name, SDL_Surface* surface) {
+		if (surface == nullptr) {
+			return false;
+		}
+		pending_.push_back(Image{name, surface});
+		return true;
+	}
+
+	void SpriteAtlas::pack() {
+		// Packing the highest images first leaves less space unused.
+		std::stable_sort(pending_.begin(), pending_.end(), [](const Image& a, const Image& b) {
+			return a.surface_->h > b.surface_->h;
+		});
+
+		std::vector<Image> images;
+		std::vector<Region> regions;
+		Skyline skyline(pageWidth_, pageHeight_);
+		for (const Image& image : pending_) {
+			int width = image.surface_->w + 2 * PADDING;
+			int height = image.surface_->h + 2 * PADDING;
+			if (width > pageWidth_ || height > pageHeight_) {
+				// Too large, gets a page of its own.
+				createPage({image}, {Region{0, PADDING, PADDING, image.surface_->w, image.surface_->h}}, width, height);
+				continue;
+			}
+			int x, y;
+			if (!skyline.insert(width, height, x, y)) {
+				createPage(images, regions, pageWidth_, pageHeight_);
+				images.clear();
+				regions.clear();
+				skyline = Skyline(pageWidth_, pageHeight_);
+				skyline.insert(width, height, x, y);
+			}
+			images.push_back(image);
+			regions.push_back(Region{0, x + PADDING, y + PADDING, image.surface_->w, image.surface_->h});
+		}
+		if (!images.empty()) {
+			createPage(images, regions, pageWidth_, pageHeight_);
+		}
+
+		for (Image& image : pending_) {
+			SDL_FreeSurface(image.surface_);
+		}
+		pending_.clear();
+	}
+
+	void SpriteAtlas::createPage(const std::vector<Image>& images, const std::vector<Region>& regions, int width, int height) {
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+		SDL_Surface* page = SDL_CreateRGBSurface(0, width, height, 32, 0xff000000, 0x00ff0000, 0x0000ff00, 0x000000ff);
+#else
+		SDL_Surface* page = SDL_CreateRGBSurface(0, width, height, 32, 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000);
+#endif
+		if (page == nullptr) {
+			return;
+		}
+
+		int pageIndex = (int) pages_.size();
+		for (unsigned int i = 0; i < images.size(); ++i) {
+			Region region = regions[i];
+			region.page_ = pageIndex;
+			// Copy the alpha channel as is.
+			SDL_SetSurfaceBlendMode(images[i].surface_, SDL_BLENDMODE_NONE);
+			SDL_Rect dst = {region.x_, region.y_, region.width_, region.height_};
+			SDL_BlitSurface(images[i].surface_, nullptr, page, &dst);
+
+			// The surface's first row is the top row, the sprite's origin is in the lower left corner.
+			region.y_ = height - region.y_ - region.height_;
+			regions_[images[i].name_] = region;
+		}
+		// The texture takes the ownership of the surface.
+		pages_.push_back(mw::Texture(page));
+	}
+
+	mw::Sprite SpriteAtlas::getSprite(const std::string& name) const {
+		auto it = regions_.find(name);
+		if (it == regions_.end()) {
+			return mw::Sprite();
+		}
+		const Region& region = it->second;
+		return mw::Sprite(pages_[region.page_], (float) region.x_, (float) region.y_,
+			(float) region.width_, (float) region.height_);
+	}
+
+	bool SpriteAtlas::contains(const std::string& name) const {
+		return regions_.find(name) != regions_.end();
+	}
+
+} // Namespace gui.
@@ -0,0 +1,72 @@
+#ifndef GUI_SPRITEATLAS_H
+#define GUI_SPRITEATLAS_H
+
+#include <mw/sprite.h>
+#include <mw/texture.h>
+
+#include <SDL.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace gui {
+
+	// Packs images into one or a few large textures, called pages, so
+	// sprites from the same page are drawn without changing texture.
+	// The sprites are used as any other sprite, e.g. by the widgets.
+	class SpriteAtlas {
+	public:
+		SpriteAtlas(int pageWidth = 1024, int pageHeight = 1024);
+
+		~SpriteAtlas();
+
+		SpriteAtlas(const SpriteAtlas&) = delete;
+		SpriteAtlas& operator=(const SpriteAtlas&) = delete;
+
+		// Add the image file, named by the file path.
+		// Return false if the image could not be loaded.
+		bool add(const std::string& file);
+
+		// Add the image with the name. Takes the ownership of the surface.
+		// Return false if the surface is null.
+		bool add(const std::string& name, SDL_Surface* surface);
+
+		// Pack the images added since the last call into new pages.
+		// Must be called before the sprites are used.
+		void pack();
+
+		// Return the sprite for the packed image with the name. Return
+		// a empty sprite if no image with the name is packed.
+		mw::Sprite getSprite(const std::string& name) const;
+
+		bool contains(const std::string& name) const;
+
+		int getPageCount() const {
+			return (int) pages_.size();
+		}
+
+	private:
+		struct Image {
+			std::string name_;
+			SDL_Surface* surface_;
+		};
+
+		struct Region {
+			int page_;
+			int x_, y_;
+			int width_, height_;
+		};
+
+		// Create a page from the images, placed at the regions.
+		void createPage(const std::vector<Image>& images, const std::vector<Region>& regions, int width, int height);
+
+		int pageWidth_, pageHeight_;
+		std::vector<Image> pending_;
+		std::map<std::string, Region> regions_;
+		std::vector<mw::Texture> pages_;
+	};
+
+} // Namespace gui.
+
+#endif // GUI_SPRITEATLAS_H
@@ -0,0 +1,94 @@
+#include "textcache.h"
+
+#include <functional>
+#include <iterator>
+
+namespace gui {
+
+	size_t TextCache::KeyHash::operator()(const Key& key) const {
+		size_t hash = std::hash<std::string>()(key.text_);
+		hash ^= std::hash<const GlyphAtlas*>()(key.atlas_) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		return hash;
+	}
+
+	std::shared_ptr<const GlyphRun> TextCache::layout(GlyphAtlas& atlas, const std::string& text) {
+		auto run = std::make_shared<GlyphRun>();
+		float x = 0;
+		size_t index = 0;
+		while (index < text.size()) {
+			int first = (int) index;
+			const Glyph& glyph = atlas.getGlyph(decodeUtf8(text, index));
+			if (glyph.width_ > 0 && glyph.height_ > 0) {
+				run->quads_.push_back(GlyphQuad{x, 0, glyph.width_, glyph.height_, glyph.x_, glyph.y_, first});
+			}
+			x += glyph.advance_;
+		}
+		run->quads_.shrink_to_fit();
+		run->width_ = x;
+		run->height_ = text.empty() ? 0 : atlas.getLineHeight();
+		return run;
+	}
+
+	TextCache& TextCache::getInstance() {
+		static TextCache cache;
+		return cache;
+	}
+
+	TextCache::TextCache(size_t byteBudget) : byteBudget_(byteBudget), bytes_(0), statistics_{0, 0, 0} {
+	}
+
+	std::shared_ptr<const GlyphRun> TextCache::get(const std::shared_ptr<GlyphAtlas>& atlas, const std::string& text) {
+		Key key{atlas.get(), text};
+		auto it = lookup_.find(key);
+		if (it != lookup_.end() && it->second->atlas_.expired()) {
+			// Laid out by a released atlas at the same address.
+			erase(it->second);
+			it = lookup_.end();
+		}
+		if (it != lookup_.end()) {
+			++statistics_.hits_;
+			// Move to the front, i.e. most recently used.
+			entries_.splice(entries_.begin(), entries_, it->second);
+			return it->second->run_;
+		}
+
+		++statistics_.misses_;
+		std::shared_ptr<const GlyphRun> run = layout(*atlas, text);
+		size_t bytes = sizeof(Entry) + 2 * text.size() + sizeof(GlyphRun)
+			+ run->quads_.size() * sizeof(GlyphQuad);
+		entries_.push_front(Entry{key, run, atlas, bytes});
+		lookup_[key] = entries_.begin();
+		bytes_ += bytes;
+		evict();
+		return run;
+	}
+
+	void TextCache::setByteBudget(size_t bytes) {
+		byteBudget_ = bytes;
+		evict();
+	}
+
+	void TextCache::resetStatistics() {
+		statistics_ = Statistics{0, 0, 0};
+	}
+
+	void TextCache::clear() {
+		lookup_.clear();
+		entries_.clear();
+		bytes_ = 0;
+	}
+
+	void TextCache::evict() {
+		while (bytes_ > byteBudget_ && !entries_.empty()) {
+			erase(std::prev(entries_.end()));
+			++statistics_.evictions_;
+		}
+	}
+
+	void TextCache::erase(std::list<Entry>::iterator it) {
+		bytes_ -= it->bytes_;
+		lookup_.erase(it->key_);
+		entries_.erase(it);
+	}
+
+} // Namespace gui.
@@ -0,0 +1,122 @@
+#ifndef GUI_TEXTCACHE_H
+#define GUI_TEXTCACHE_H
+
+#include "glyphatlas.h"
+
+#include <SDL_ttf.h>
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gui {
+
+	// A glyph placed relative to the lower left corner of the text.
+	struct GlyphQuad {
+		float x_, y_;
+		float width_, height_;
+		float atlasX_, atlasY_;
+		int index_; // First byte of the character in the text.
+	};
+
+	// A string laid out as quads referencing a glyph atlas.
+	struct GlyphRun {
+		std::vector<GlyphQuad> quads_;
+		float width_, height_;
+	};
+
+	// Process wide cache of laid out text, keyed by glyph atlas and string.
+	// Equal strings in the same font share one glyph run, e.g. button
+	// captions, units and headers repeated all over the gui. The glyphs
+	// themselves are shared through the font's GlyphAtlas.
+	// The least recently used runs are dropped when the cache uses more than
+	// the byte budget, runs still used by some text stays alive until the
+	// text is gone. The atlases are not kept alive by the cache, the runs of
+	// a released atlas are dropped when found. Not thread safe, use from the
+	// OpenGL thread.
+	class TextCache {
+	public:
+		struct Statistics {
+			int hits_;
+			int misses_;
+			int evictions_;
+		};
+
+		static TextCache& getInstance();
+
+		// Lay out the text without using the cache.
+		static std::shared_ptr<const GlyphRun> layout(GlyphAtlas& atlas, const std::string& text);
+
+		TextCache(size_t byteBudget = 1024 * 1024);
+
+		TextCache(const TextCache&) = delete;
+		TextCache& operator=(const TextCache&) = delete;
+
+		// Return the run for the text, laid out with the atlas.
+		std::shared_ptr<const GlyphRun> get(const std::shared_ptr<GlyphAtlas>& atlas, const std::string& text);
+
+		void setByteBudget(size_t bytes);
+
+		size_t getByteBudget() const {
+			return byteBudget_;
+		}
+
+		// Return the estimated number of bytes used by the cached runs.
+		size_t getBytes() const {
+			return bytes_;
+		}
+
+		int getSize() const {
+			return (int) entries_.size();
+		}
+
+		const Statistics& getStatistics() const {
+			return statistics_;
+		}
+
+		void resetStatistics();
+
+		// Remove all runs from the cache.
+		void clear();
+
+	private:
+		struct Key {
+			const GlyphAtlas* atlas_;
+			std::string text_;
+
+			bool operator==(const Key& key) const {
+				return atlas_ == key.atlas_ && text_ == key.text_;
+			}
+		};
+
+		struct KeyHash {
+			size_t operator()(const Key& key) const;
+		};
+
+		struct Entry {
+			Key key_;
+			std::shared_ptr<const GlyphRun> run_;
+			// Expired when the atlas is released, i.e. the atlas pointer in
+			// the key may be reused by another atlas.
+			std::weak_ptr<GlyphAtlas> atlas_;
+			size_t bytes_;
+		};
+
+		// Drop the least recently used entries until inside the budget.
+		void evict();
+
+		void erase(std::list<Entry>::iterator it);
+
+		std::list<Entry> entries_; // Most recently used first.
+		std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> lookup_;
+		size_t byteBudget_;
+		size_t bytes_;
+		Statistics statistics_;
+	};
+
+} // Namespace gui.
+
+#endif // GUI_TEXTCACHE_H
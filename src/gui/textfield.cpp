@@ -1,19 +1,24 @@
 #include "textfield.h"
 
+#include <algorithm>
+
 namespace gui {
 
 	TextField::TextField(const mw::Font& font) : TextField("", font) {
 	}
 
 	TextField::TextField(std::string initialText, const mw::Font& font) :
-		font_(font), editable_(true), textColor_(0, 0, 0),
-		alignment_(LEFT), markerDeltaTime_(0), markerChanged_(false) {
+		editable_(true), markerChanged_(false), font_(font), textColor_(0, 0, 0),
+		alignment_(LEFT), markerDeltaTime_(0) {
 		
 		setPreferredSize(150, 20);
 		setBackgroundColor(0.8f, 0.8f, 0.8f);
 		
-		inputFormatter_.update(initialText.c_str());
-		text_ = mw::Text(inputFormatter_.getText(), font);
+		text_ = GlyphText("", font);
+		// Edited text is unlikely to be shared.
+		text_.setCached(false);
+		inputFormatter_.setText(initialText);
+		inserted(0, inputFormatter_.getSize());
 		// One pixel to the right of the last character.
 		markerWidth_ = text_.getWidth() + 1;
 	}
@@ -25,13 +30,18 @@ namespace gui {
 
 	// Set the current text.
 	void TextField::setText(std::string text) {
-		text_.setText(text);
-		markerWidth_ = text_.getWidth() - 1;
+		// The input formatter must hold the same text, the offsets follow its edits.
+		erased(0, inputFormatter_.getSize());
+		inputFormatter_.setText(text);
+		inserted(0, inputFormatter_.getSize());
+		markerWidth_ = text_.getWidth() + 1;
+		repaint();
 	}
 
 	// Set the textfield to be editable or not.
 	void TextField::setEditable(bool editable) {
 		editable_ = editable;
+		repaint();
 	}
 
 	bool TextField::isEditable() const {
@@ -40,30 +50,18 @@ namespace gui {
 
 	void TextField::setTextColor(const mw::Color& color) {
 		textColor_ = color;
+		repaint();
 	}
 
 	void TextField::setTextColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
 		textColor_ = mw::Color(red, green, blue, alpha);
+		repaint();
 	}
 
 	void TextField::draw(const Graphic& graphic, double deltaTime) {
 		Component::draw(graphic, deltaTime);
 
-		Dimension dim = getSize();
-		float x = 0.0;
-		// Text should 
-		switch (alignment_) {
-			case Alignment::LEFT:
-				x = 2;
-				break;
-			case Alignment::CENTER:
-				x = dim.width_ * 0.5f - (text_.getWidth() - 2) * 0.5f;
-				break;
-			case Alignment::RIGHT:
-				x = dim.width_ - text_.getWidth() - 2;
-				break;
-		}
-
+		float x = getTextX();
 		graphic.setColor(textColor_);
 		graphic.drawText(text_, x, 0);
 		if (editable_) {
@@ -74,6 +72,8 @@ namespace gui {
 				} else if (markerDeltaTime_ > 1.0) {
 					markerDeltaTime_ = 0;
 				}
+				// Keep the marker blinking.
+				repaint();
 			} else {
 				markerDeltaTime_ = 0;
 			}
@@ -86,6 +86,7 @@ namespace gui {
 
 	void TextField::setAlignment(TextField::Alignment alignment) {
 		alignment_ = alignment;
+		repaint();
 	}
 
 	void TextField::handleKeyboard(const SDL_Event& keyEvent) {
@@ -93,11 +94,12 @@ namespace gui {
 			switch (keyEvent.type) {
 				case SDL_TEXTINPUT:
 					// Update only if the glyph is avaiable.
-					if (font_.getTtfFont() != 0 && 0 == TTF_SizeUTF8(font_.getTtfFont(), keyEvent.text.text, 0, 0)) {
+					if (isProvided(keyEvent.text.text)) {
 						// A Utf8 string as input.
+						int position = inputFormatter_.getMarkerPosition();
+						int size = inputFormatter_.getSize();
 						inputFormatter_.update(keyEvent.text.text);
-						text_.setText(inputFormatter_.getText());
-						markerChanged_ = true;
+						inserted(position, inputFormatter_.getSize() - size);
 					}
 					break;
 				case SDL_KEYDOWN:
@@ -107,23 +109,24 @@ namespace gui {
 						case SDLK_v: // Paste from clipboard!
 							if ((keyEvent.key.keysym.mod & KMOD_CTRL) && SDL_HasClipboardText()) {
 								char* text = SDL_GetClipboardText();
-								inputFormatter_.update(SDL_GetClipboardText());
-								text_.setText(inputFormatter_.getText());
-								markerChanged_ = true;
+								int position = inputFormatter_.getMarkerPosition();
+								int size = inputFormatter_.getSize();
+								inputFormatter_.update(text);
+								inserted(position, inputFormatter_.getSize() - size);
 								SDL_free(text);
 							}
 							break;
 						case SDLK_c: // Copy from textfield!
 							if (keyEvent.key.keysym.mod & KMOD_CTRL) {
-								SDL_SetClipboardText(inputFormatter_.getText().c_str());
+								SDL_SetClipboardText(text_.getText().c_str());
 							}
 							break;
 						case SDLK_x: // Cut from textfield!
 							if (keyEvent.key.keysym.mod & KMOD_CTRL) {
-								SDL_SetClipboardText(inputFormatter_.getText().c_str());
+								SDL_SetClipboardText(text_.getText().c_str());
+								int size = inputFormatter_.getSize();
 								inputFormatter_.clear();
-								text_.setText(inputFormatter_.getText());
-								markerChanged_ = true;
+								erased(0, size);
 							}
 							break;
 						case SDLK_HOME:
@@ -143,15 +146,19 @@ namespace gui {
 							markerChanged_ = true;
 							break;
 						case SDLK_BACKSPACE:
+						{
+							int size = inputFormatter_.getSize();
 							inputFormatter_.update(InputFormatter::INPUT_ERASE_LEFT);
-							text_.setText(inputFormatter_.getText());
-							markerChanged_ = true;
+							erased(inputFormatter_.getMarkerPosition(), size - inputFormatter_.getSize());
 							break;
+						}
 						case SDLK_DELETE:
+						{
+							int size = inputFormatter_.getSize();
 							inputFormatter_.update(InputFormatter::INPUT_ERASE_RIGHT);
-							text_.setText(inputFormatter_.getText());
-							markerChanged_ = true;
+							erased(inputFormatter_.getMarkerPosition(), size - inputFormatter_.getSize());
 							break;
+						}
 						case SDLK_RETURN:
 							// Fall through!
 						case SDLK_KP_ENTER:
@@ -162,16 +169,91 @@ namespace gui {
 			}
 			if (markerChanged_) {
 				markerChanged_ = false;
-				int index = inputFormatter_.getMarkerPosition();
-				std::string leftText = getText().substr(0, index);
-				int w, h;
-				if (font_.getTtfFont()) {
-					TTF_SizeUTF8(font_.getTtfFont(), leftText.c_str(), &w, &h);
-					// One pixel to the right of the last character.
-				}
-				markerWidth_ = (float) w + 1;
+				repaint();
+				// One pixel to the right of the last character.
+				markerWidth_ = advances_.getSum(inputFormatter_.getMarkerPosition()) + 1;
 			}
 		}
 	}
 
+	void TextField::handleMouse(const SDL_Event& mouseEvent) {
+		if (editable_ && mouseEvent.type == SDL_MOUSEBUTTONDOWN && mouseEvent.button.button == SDL_BUTTON_LEFT) {
+			// Move the marker to the character boundary closest to the click.
+			inputFormatter_.setMarkerPosition(getPositionAt(mouseEvent.button.x - getTextX()));
+			markerWidth_ = advances_.getSum(inputFormatter_.getMarkerPosition()) + 1;
+			markerDeltaTime_ = 0;
+			repaint();
+		}
+		Component::handleMouse(mouseEvent);
+	}
+
+	float TextField::getTextX() const {
+		Dimension dim = getSize();
+		switch (alignment_) {
+			case Alignment::CENTER:
+				return dim.width_ * 0.5f - (text_.getWidth() - 2) * 0.5f;
+			case Alignment::RIGHT:
+				return dim.width_ - text_.getWidth() - 2;
+			default:
+				return 2;
+		}
+	}
+
+	bool TextField::isProvided(const std::string& text) const {
+		const std::shared_ptr<GlyphAtlas>& atlas = text_.getAtlas();
+		if (atlas == nullptr) {
+			return false;
+		}
+		size_t index = 0;
+		while (index < text.size()) {
+			// Rasterized once, and then used by the text.
+			if (!atlas->getGlyph(decodeUtf8(text, index)).provided_) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void TextField::inserted(int position, int bytes) {
+		// The inserted bytes are just before the gap.
+		std::string_view before, after;
+		inputFormatter_.getText(before, after);
+		text_.replace(position, 0, before.substr(before.size() - bytes));
+		markerChanged_ = true;
+
+		const std::string& text = text_.getText();
+		const std::shared_ptr<GlyphAtlas>& atlas = text_.getAtlas();
+		insertedAdvances_.assign(bytes, 0.f);
+		size_t index = position;
+		size_t end = position + bytes;
+		while (index < end) {
+			Uint16 character = decodeUtf8(text, index);
+			index = std::min(index, end);
+			insertedAdvances_[index - 1 - position] = atlas != nullptr ? atlas->getGlyph(character).advance_ : 0;
+		}
+		advances_.insert(position, insertedAdvances_.data(), bytes);
+	}
+
+	void TextField::erased(int position, int bytes) {
+		text_.replace(position, bytes, std::string_view());
+		markerChanged_ = true;
+
+		advances_.erase(position, bytes);
+	}
+
+	int TextField::getPositionAt(float x) const {
+		// The bytes inside a character share the offset of the first byte,
+		// i.e. the search finds the start of a character.
+		int after = advances_.lowerBound(x);
+		if (after > advances_.getSize()) {
+			return advances_.getSize();
+		}
+		if (after == 0) {
+			return 0;
+		}
+		float beforeX = advances_.getSum(after - 1);
+		int before = advances_.lowerBound(beforeX);
+		return x - beforeX < advances_.getSum(after) - x ? before : after;
+	}
+
 } // Namespace gui.
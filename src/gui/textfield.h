@@ -3,11 +3,13 @@
 
 #include "component.h"
 #include "inputformatter.h"
+#include "glyphtext.h"
+#include "blockedsums.h"
 
-#include <mw/text.h>
 #include <mw/font.h>
 
 #include <string>
+#include <vector>
 
 namespace gui {
 
@@ -36,6 +38,16 @@ namespace gui {
 
 		bool isEditable() const;
 
+		// Set the max number of bytes the user can enter, e.g. by typing or
+		// pasting. Not limiting setText(). Default is 30.
+		void setMaxLimit(int maxLimit) {
+			inputFormatter_.setMaxLimit(maxLimit);
+		}
+
+		int getMaxLimit() const {
+			return inputFormatter_.getMaxLimit();
+		}
+
 		virtual void draw(const Graphic& graphic, double deltaTime) override;
 
 		Alignment getAlignment() const;
@@ -50,8 +62,33 @@ namespace gui {
 	private:
 		void handleKeyboard(const SDL_Event& keyEvent) override;
 
+		void handleMouse(const SDL_Event& mouseEvent) override;
+
+		// Return the x position of the text, based on the alignment.
+		float getTextX() const;
+
+		// Return true if the font provides all characters in the utf8 text.
+		bool isProvided(const std::string& text) const;
+
+		// Update the text and the advances after the bytes are inserted at
+		// the position by the input formatter.
+		void inserted(int position, int bytes);
+
+		// Update the text and the advances after the bytes are erased at
+		// the position by the input formatter.
+		void erased(int position, int bytes);
+
+		// Return the position in the utf8 string closest to x, relative
+		// to the start of the text.
+		int getPositionAt(float x) const;
+
 		bool editable_;
-		mw::Text text_;
+		GlyphText text_;
+		// The glyph advance of each utf8 character, stored at its last byte.
+		// The other bytes are zero. The sum of the advances before a byte is
+		// the x position of its character, relative to the start of the text.
+		BlockedSums advances_;
+		std::vector<float> insertedAdvances_; // Used by inserted().
 		float markerWidth_;
 		bool markerChanged_;
 		mw::Font font_;
@@ -0,0 +1,131 @@
+#include "threadpool.h"
+
+#include <algorithm>
+
+namespace gui {
+
+	thread_local const ThreadPool* ThreadPool::currentPool_ = nullptr;
+	thread_local int ThreadPool::currentQueue_ = -1;
+
+	ThreadPool& ThreadPool::getInstance() {
+		static ThreadPool pool;
+		return pool;
+	}
+
+	ThreadPool::ThreadPool(int threads) : queued_(0), stop_(false) {
+		if (threads <= 0) {
+			threads = std::max(1, (int) std::thread::hardware_concurrency() - 1);
+		}
+		for (int i = 0; i <= threads; ++i) {
+			queues_.push_back(std::make_unique<Queue>());
+		}
+		for (int i = 0; i < threads; ++i) {
+			threads_.emplace_back(&ThreadPool::work, this, i);
+		}
+	}
+
+	ThreadPool::~ThreadPool() {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stop_ = true;
+		}
+		condition_.notify_all();
+		for (auto& thread : threads_) {
+			thread.join();
+		}
+	}
+
+	void ThreadPool::run(int count, const Task& task) {
+		if (count <= 1 || threads_.empty()) {
+			for (int i = 0; i < count; ++i) {
+				task(i);
+			}
+			return;
+		}
+
+		std::atomic<int> remaining(count);
+		int queue = getQueue();
+		{
+			std::lock_guard<std::mutex> lock(queues_[queue]->mutex_);
+			// The first index is taken first by this thread.
+			for (int i = count - 1; i >= 0; --i) {
+				queues_[queue]->jobs_.push_back(Job{&task, i, &remaining});
+			}
+		}
+		{
+			// Under the lock, a thread about to wait sees the new jobs.
+			std::lock_guard<std::mutex> lock(mutex_);
+			queued_ += count;
+		}
+		condition_.notify_all();
+
+		// Help until all jobs are done, they may be run by other threads.
+		while (remaining.load(std::memory_order_acquire) > 0) {
+			Job job;
+			if (pop(queue, job) || steal(queue, job)) {
+				execute(job);
+			} else {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	bool ThreadPool::pop(int queue, Job& job) {
+		Queue& q = *queues_[queue];
+		std::lock_guard<std::mutex> lock(q.mutex_);
+		if (q.jobs_.empty()) {
+			return false;
+		}
+		job = q.jobs_.back();
+		q.jobs_.pop_back();
+		--queued_;
+		return true;
+	}
+
+	bool ThreadPool::steal(int queue, Job& job) {
+		int size = (int) queues_.size();
+		for (int i = 1; i < size; ++i) {
+			Queue& q = *queues_[(queue + i) % size];
+			std::lock_guard<std::mutex> lock(q.mutex_);
+			if (!q.jobs_.empty()) {
+				job = q.jobs_.front();
+				q.jobs_.pop_front();
+				--queued_;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void ThreadPool::execute(const Job& job) {
+		(*job.task_)(job.index_);
+		job.remaining_->fetch_sub(1, std::memory_order_release);
+	}
+
+	void ThreadPool::work(int queue) {
+		currentPool_ = this;
+		currentQueue_ = queue;
+		while (true) {
+			Job job;
+			if (pop(queue, job) || steal(queue, job)) {
+				execute(job);
+				continue;
+			}
+			std::unique_lock<std::mutex> lock(mutex_);
+			condition_.wait(lock, [&]() {
+				return stop_ || queued_ > 0;
+			});
+			if (stop_) {
+				return;
+			}
+		}
+	}
+
+	int ThreadPool::getQueue() const {
+		if (currentPool_ == this) {
+			return currentQueue_;
+		}
+		return (int) queues_.size() - 1;
+	}
+
+} // Namespace gui.
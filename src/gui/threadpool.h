@@ -0,0 +1,83 @@
+#ifndef GUI_THREADPOOL_H
+#define GUI_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gui {
+
+	// Work stealing thread pool for short fork/join tasks, e.g. laying out
+	// sibling subtrees. Each thread has its own queue, a thread takes its
+	// own tasks newest first and steals the oldest tasks from the others
+	// when it has none left. The thread calling run() works on the tasks
+	// too, i.e. a task may call run() again without blocking a thread.
+	class ThreadPool {
+	public:
+		using Task = std::function<void(int)>;
+
+		// The pool shared by the gui, started on first use.
+		static ThreadPool& getInstance();
+
+		// Create a pool using the number of threads, besides the calling
+		// thread. Zero means one thread less than the number of cores.
+		explicit ThreadPool(int threads = 0);
+
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		// Call the task with each index in [0, count), spread over the
+		// threads. Return when all calls are done.
+		void run(int count, const Task& task);
+
+		int getThreadCount() const {
+			return (int) threads_.size();
+		}
+
+	private:
+		struct Job {
+			const Task* task_;
+			int index_;
+			std::atomic<int>* remaining_;
+		};
+
+		struct Queue {
+			std::mutex mutex_;
+			std::deque<Job> jobs_;
+		};
+
+		// Take the newest job from the queue.
+		bool pop(int queue, Job& job);
+
+		// Take the oldest job from any other queue.
+		bool steal(int queue, Job& job);
+
+		void execute(const Job& job);
+
+		void work(int queue);
+
+		// The queue used by the current thread, the last queue is
+		// shared by the threads not belonging to any pool.
+		int getQueue() const;
+
+		static thread_local const ThreadPool* currentPool_;
+		static thread_local int currentQueue_;
+
+		std::vector<std::unique_ptr<Queue>> queues_;
+		std::vector<std::thread> threads_;
+		std::atomic<int> queued_; // Jobs in all queues.
+		std::mutex mutex_;
+		std::condition_variable condition_;
+		bool stop_;
+	};
+
+} // Namespace gui.
+
+#endif // GUI_THREADPOOL_H
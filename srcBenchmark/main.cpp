@@ -0,0 +1,412 @@
+#include <gui/frame.h>
+#include <gui/headless.h>
+#include <gui/panel.h>
+#include <gui/label.h>
+#include <gui/button.h>
+#include <gui/textfield.h>
+#include <gui/borderlayout.h>
+#include <gui/gridlayout.h>
+#include <gui/textcache.h>
+#include <gui/mpscqueue.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+	const int WIDTH = 1024;
+	const int HEIGHT = 768;
+	const int GROUP_SIZE = 100;
+	const int FRAMES = 100;
+	const int EVENTS_PER_FRAME = 50;
+
+	double percentile(std::vector<double> values, double fraction) {
+		int index = std::min((int) values.size() - 1, std::max(0, (int) std::ceil(fraction * values.size()) - 1));
+		std::nth_element(values.begin(), values.begin() + index, values.end());
+		return values[index];
+	}
+
+	// Add the components in groups of GROUP_SIZE, each group in its own panel.
+	std::shared_ptr<gui::Panel> createTree(gui::Frame& frame, const mw::Font& font, int components) {
+		int groups = (components + GROUP_SIZE - 1) / GROUP_SIZE;
+		int columns = (int) std::ceil(std::sqrt(groups));
+		auto center = frame.add<gui::Panel>(gui::BorderLayout::CENTER);
+		center->setLayout<gui::GridLayout>((groups + columns - 1) / columns, columns);
+
+		gui::Panel::BatchUpdate batchUpdate(*center);
+		for (int group = 0; group < groups; ++group) {
+			auto panel = center->addDefault<gui::Panel>();
+			panel->setLayout<gui::GridLayout>(10, 10);
+			std::vector<std::shared_ptr<gui::Component>> labels;
+			for (int i = 0; i < GROUP_SIZE && group * GROUP_SIZE + i < components; ++i) {
+				labels.push_back(frame.create<gui::Label>(std::to_string(i), font));
+			}
+			panel->addAll(labels);
+		}
+		return center;
+	}
+
+	// Add the location and size of all descendants.
+	void collectRects(const gui::Panel& panel, std::vector<float>& rects) {
+		for (const auto& component : panel.getComponents()) {
+			gui::Point p = component->getLocation();
+			gui::Dimension d = component->getSize();
+			rects.insert(rects.end(), {p.x_, p.y_, d.width_, d.height_});
+			if (auto child = std::dynamic_pointer_cast<gui::Panel>(component)) {
+				collectRects(*child, rects);
+			}
+		}
+	}
+
+	// Draw the same frame directly and through the sorted draw list, the
+	// pixels must be the same. The recorded list must be the same each frame.
+	// Return false if the check fails.
+	bool checkDrawList() {
+		gui::Headless headless(std::make_unique<gui::Frame>(), WIDTH, HEIGHT);
+		if (!headless.isValid()) {
+			std::cout << "draw list check skipped, no OpenGL context\n";
+			return true;
+		}
+		gui::Frame& frame = headless.getFrame();
+		mw::Font font("Ubuntu-B.ttf", 8);
+		createTree(frame, font, 1000);
+		headless.step();
+		std::vector<Uint8> directPixels = headless.readPixels();
+
+		frame.setDrawListEnabled(true);
+		headless.step();
+		std::vector<Uint8> sortedPixels = headless.readPixels();
+		std::ostringstream first;
+		frame.getDrawList().write(first);
+		headless.step();
+		std::ostringstream second;
+		frame.getDrawList().write(second);
+
+		bool passed = true;
+		if (frame.getDrawList().getSize() == 0 || first.str() != second.str()) {
+			std::cout << "draw list check failed, the recorded frames differ\n";
+			passed = false;
+		}
+		if (directPixels != sortedPixels) {
+			std::cout << "draw list check failed, the sorted draw list changes the pixels\n";
+			passed = false;
+		}
+		return passed;
+	}
+
+	// Press and release the left mouse button in the middle of the
+	// component, which must be a child of the frame's current panel.
+	void click(gui::Headless& headless, const gui::Component& component) {
+		gui::Point p = component.getLocation();
+		gui::Dimension d = component.getSize();
+		SDL_Event sdlEvent = {};
+		sdlEvent.button.button = SDL_BUTTON_LEFT;
+		sdlEvent.button.x = (Sint32) (p.x_ + d.width_ * 0.5f);
+		// The y-axis is pointing down.
+		sdlEvent.button.y = (Sint32) (headless.getHeight() - p.y_ - d.height_ * 0.5f);
+		sdlEvent.type = SDL_MOUSEBUTTONDOWN;
+		headless.injectEvent(sdlEvent);
+		sdlEvent.type = SDL_MOUSEBUTTONUP;
+		headless.injectEvent(sdlEvent);
+	}
+
+	// Click a button which colors a panel, and type into a text field.
+	// The panel's pixels and the text must follow. Return false if the
+	// check fails.
+	bool checkEvents() {
+		gui::Headless headless(std::make_unique<gui::Frame>(), WIDTH, HEIGHT);
+		if (!headless.isValid()) {
+			std::cout << "event check skipped, no OpenGL context\n";
+			return true;
+		}
+		gui::Frame& frame = headless.getFrame();
+		mw::Font font("Ubuntu-B.ttf", 16);
+		auto button = frame.add<gui::Button>(gui::BorderLayout::NORTH, "Red", font);
+		auto textField = frame.add<gui::TextField>(gui::BorderLayout::SOUTH, "", font);
+		auto center = frame.add<gui::Panel>(gui::BorderLayout::CENTER);
+		center->setBackgroundColor(1, 1, 1);
+		button->addActionListener([&](gui::Component&) {
+			center->setBackgroundColor(1, 0, 0);
+		});
+		headless.step();
+
+		bool passed = true;
+		click(headless, *button);
+		headless.step();
+		gui::Point p = center->getLocation();
+		gui::Dimension d = center->getSize();
+		std::vector<Uint8> pixel = headless.readPixels((int) (p.x_ + d.width_ * 0.5f), (int) (p.y_ + d.height_ * 0.5f), 1, 1);
+		if (pixel[0] != 255 || pixel[1] != 0 || pixel[2] != 0) {
+			std::cout << "event check failed, the clicked button did not color the panel red\n";
+			passed = false;
+		}
+
+		click(headless, *textField);
+		SDL_Event sdlEvent = {};
+		sdlEvent.type = SDL_TEXTINPUT;
+		std::strcpy(sdlEvent.text.text, "abc");
+		headless.injectEvent(sdlEvent);
+		sdlEvent = {};
+		sdlEvent.type = SDL_KEYDOWN;
+		sdlEvent.key.keysym.sym = SDLK_BACKSPACE;
+		headless.injectEvent(sdlEvent);
+		headless.step();
+		if (textField->getText() != "ab") {
+			std::cout << "event check failed, the text field holds \"" << textField->getText() << "\" instead of \"ab\"\n";
+			passed = false;
+		}
+		return passed;
+	}
+
+	// Return the median layout time when the window width changes every frame.
+	double measureLayout(gui::Frame& frame, gui::Headless& headless) {
+		std::vector<double> layoutTimes;
+		for (int i = 0; i < FRAMES; ++i) {
+			SDL_Event sdlEvent = {};
+			sdlEvent.type = SDL_WINDOWEVENT;
+			sdlEvent.window.event = SDL_WINDOWEVENT_RESIZED;
+			sdlEvent.window.data1 = WIDTH - i % 2;
+			sdlEvent.window.data2 = HEIGHT;
+			headless.injectEvent(sdlEvent);
+			headless.step();
+			layoutTimes.push_back(frame.getStatistics().getTime(gui::FrameStatistics::LAYOUT).getLast());
+		}
+		return percentile(layoutTimes, 0.5);
+	}
+
+	// Compare the layout of the groups one after another with the parallel
+	// layout, which must give the same positions and sizes.
+	void benchmarkParallelLayout(int components) {
+		gui::Headless headless(std::make_unique<gui::Frame>(), WIDTH, HEIGHT);
+		if (!headless.isValid()) {
+			return;
+		}
+		gui::Frame& frame = headless.getFrame();
+		mw::Font font("Ubuntu-B.ttf", 8);
+		auto center = createTree(frame, font, components);
+		headless.step();
+
+		double sequentialTime = measureLayout(frame, headless);
+		std::vector<float> sequentialRects;
+		collectRects(*center, sequentialRects);
+
+		center->setParallelLayout(true);
+		double parallelTime = measureLayout(frame, headless);
+		std::vector<float> parallelRects;
+		collectRects(*center, parallelRects);
+
+		bool identical = sequentialRects.size() == parallelRects.size()
+			&& std::memcmp(sequentialRects.data(), parallelRects.data(), sequentialRects.size() * sizeof(float)) == 0;
+		std::cout << std::setw(10) << components
+			<< std::fixed << std::setprecision(3)
+			<< std::setw(12) << sequentialTime * 1000
+			<< std::setw(12) << parallelTime * 1000
+			<< std::setw(12) << (identical ? "yes" : "no") << "\n";
+	}
+
+	void benchmark(int components) {
+		gui::Headless headless(std::make_unique<gui::Frame>(), WIDTH, HEIGHT);
+		if (!headless.isValid()) {
+			return;
+		}
+		gui::Frame& frame = headless.getFrame();
+		mw::Font font("Ubuntu-B.ttf", 8);
+		gui::TextCache& textCache = gui::TextCache::getInstance();
+		textCache.resetStatistics();
+		createTree(frame, font, components);
+		// Share of the labels reusing already laid out text.
+		const gui::TextCache::Statistics& textStatistics = textCache.getStatistics();
+		double textHitRate = (double) textStatistics.hits_ / std::max(1, textStatistics.hits_ + textStatistics.misses_);
+		headless.step();
+
+		using Clock = std::chrono::high_resolution_clock;
+
+		// Frame time, nothing changes between the frames.
+		std::vector<double> frameTimes;
+		for (int i = 0; i < FRAMES; ++i) {
+			Clock::time_point time = Clock::now();
+			headless.step();
+			frameTimes.push_back(std::chrono::duration<double>(Clock::now() - time).count());
+		}
+
+		// Layout time, the window width changes every frame which lays out all components.
+		std::vector<double> layoutTimes;
+		for (int i = 0; i < FRAMES; ++i) {
+			SDL_Event sdlEvent = {};
+			sdlEvent.type = SDL_WINDOWEVENT;
+			sdlEvent.window.event = SDL_WINDOWEVENT_RESIZED;
+			sdlEvent.window.data1 = WIDTH - i % 2;
+			sdlEvent.window.data2 = HEIGHT;
+			headless.injectEvent(sdlEvent);
+			headless.step();
+			layoutTimes.push_back(frame.getStatistics().getTime(gui::FrameStatistics::LAYOUT).getLast());
+		}
+
+		// Event dispatch time, the mouse moves over the window.
+		std::vector<double> eventTimes;
+		for (int i = 0; i < FRAMES; ++i) {
+			for (int j = 0; j < EVENTS_PER_FRAME; ++j) {
+				SDL_Event sdlEvent = {};
+				sdlEvent.type = SDL_MOUSEMOTION;
+				sdlEvent.motion.x = (i * EVENTS_PER_FRAME + j) * 7 % WIDTH;
+				sdlEvent.motion.y = (i * EVENTS_PER_FRAME + j) * 13 % HEIGHT;
+				sdlEvent.motion.xrel = 1;
+				headless.injectEvent(sdlEvent);
+			}
+			headless.step();
+			eventTimes.push_back(frame.getStatistics().getTime(gui::FrameStatistics::EVENTS).getLast() / EVENTS_PER_FRAME);
+		}
+
+		std::cout << std::setw(10) << components
+			<< std::fixed << std::setprecision(3)
+			<< std::setw(12) << percentile(frameTimes, 0.5) * 1000
+			<< std::setw(12) << percentile(frameTimes, 0.95) * 1000
+			<< std::setw(12) << percentile(layoutTimes, 0.5) * 1000
+			<< std::setw(12) << percentile(layoutTimes, 0.95) * 1000
+			<< std::setw(12) << percentile(eventTimes, 0.5) * 1000000
+			<< std::setw(12) << percentile(eventTimes, 0.95) * 1000000
+			<< std::setw(12) << textHitRate * 100 << "\n";
+	}
+
+	const int ITEMS_PER_PRODUCER = 20000;
+	const int QUEUE_CAPACITY = 4096;
+
+	// The same bounded queue as MpscQueue, but guarded by a mutex.
+	class MutexQueue {
+	public:
+		bool push(std::function<void()> value) {
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (queue_.size() >= QUEUE_CAPACITY) {
+				return false;
+			}
+			queue_.push(std::move(value));
+			return true;
+		}
+
+		bool pop(std::function<void()>& value) {
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (queue_.empty()) {
+				return false;
+			}
+			value = std::move(queue_.front());
+			queue_.pop();
+			return true;
+		}
+
+	private:
+		std::mutex mutex_;
+		std::queue<std::function<void()>> queue_;
+	};
+
+	// Return the posted functions per second, when the producers post
+	// functions as fast as possible and one consumer calls them.
+	template <class Queue>
+	double benchmarkQueue(Queue& queue, int producers) {
+		std::atomic<bool> start(false);
+		std::vector<std::thread> threads;
+		for (int i = 0; i < producers; ++i) {
+			threads.emplace_back([&]() {
+				while (!start) {
+					std::this_thread::yield();
+				}
+				for (int j = 0; j < ITEMS_PER_PRODUCER; ++j) {
+					while (!queue.push([]() {})) {
+						std::this_thread::yield();
+					}
+				}
+			});
+		}
+
+		using Clock = std::chrono::high_resolution_clock;
+		Clock::time_point time = Clock::now();
+		start = true;
+		int total = producers * ITEMS_PER_PRODUCER;
+		std::function<void()> function;
+		for (int consumed = 0; consumed < total;) {
+			if (queue.pop(function)) {
+				function();
+				++consumed;
+			}
+		}
+		double seconds = std::chrono::duration<double>(Clock::now() - time).count();
+		for (auto& thread : threads) {
+			thread.join();
+		}
+		return total / seconds;
+	}
+
+	void benchmarkQueues(int producers) {
+		gui::MpscQueue<std::function<void()>> lockFree(QUEUE_CAPACITY);
+		MutexQueue mutex;
+		double lockFreeRate = benchmarkQueue(lockFree, producers);
+		double mutexRate = benchmarkQueue(mutex, producers);
+		std::cout << std::setw(10) << producers
+			<< std::fixed << std::setprecision(2)
+			<< std::setw(12) << lockFreeRate / 1e6
+			<< std::setw(12) << mutexRate / 1e6 << "\n";
+	}
+
+}
+
+int main(int argc, char** argv) {
+	// Use the software renderer if nothing else is defined, makes the result comparable between machines.
+	SDL_setenv("LIBGL_ALWAYS_SOFTWARE", "1", 0);
+
+	bool drawListPassed = checkDrawList();
+	bool eventsPassed = checkEvents();
+	if (!drawListPassed || !eventsPassed) {
+		return 1;
+	}
+
+	std::cout << std::setw(10) << "components"
+		<< std::setw(12) << "frame p50"
+		<< std::setw(12) << "frame p95"
+		<< std::setw(12) << "layout p50"
+		<< std::setw(12) << "layout p95"
+		<< std::setw(12) << "event p50"
+		<< std::setw(12) << "event p95"
+		<< std::setw(12) << "text hits" << "\n";
+	std::cout << std::setw(10) << ""
+		<< std::setw(12) << "(ms)" << std::setw(12) << "(ms)"
+		<< std::setw(12) << "(ms)" << std::setw(12) << "(ms)"
+		<< std::setw(12) << "(us)" << std::setw(12) << "(us)"
+		<< std::setw(12) << "(%)" << "\n";
+
+	for (int components : {100, 1000, 10000, 100000}) {
+		benchmark(components);
+	}
+
+	// Panel::setParallelLayout(), using the shared thread pool.
+	std::cout << "\n" << std::setw(10) << "components"
+		<< std::setw(12) << "sequential"
+		<< std::setw(12) << "parallel"
+		<< std::setw(12) << "identical" << "\n";
+	std::cout << std::setw(10) << ""
+		<< std::setw(12) << "(ms)" << std::setw(12) << "(ms)" << "\n";
+	for (int components : {1000, 10000, 100000}) {
+		benchmarkParallelLayout(components);
+	}
+
+	// Frame::post() under contention.
+	std::cout << "\n" << std::setw(10) << "producers"
+		<< std::setw(12) << "lock free"
+		<< std::setw(12) << "mutex" << "\n";
+	std::cout << std::setw(10) << ""
+		<< std::setw(12) << "(M/s)" << std::setw(12) << "(M/s)" << "\n";
+	for (int producers : {8, 16, 32}) {
+		benchmarkQueues(producers);
+	}
+	return 0;
+}
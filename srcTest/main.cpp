@@ -13,9 +13,13 @@
 #include <gui/combobox.h>
 #include <gui/traversalgroup.h>
 #include <gui/progressbar.h>
+#include <gui/listview.h>
+#include <gui/spriteatlas.h>
 
-#include <cassert>
+#include <atomic>
+#include <cstdlib>
 #include <iostream>
+#include <new>
 
 void testBorderLayout() {
 	gui::Frame frame;
@@ -23,6 +27,9 @@ void testBorderLayout() {
 	frame.setWindowSize(512, 512);
 	frame.setDefaultClosing(true);
 	mw::Font font("Ubuntu-B.ttf", 16);
+	gui::SpriteAtlas atlas;
+	atlas.add("triangle.png");
+	atlas.pack();
 	auto b = frame.add<gui::Button>(gui::BorderLayout::NORTH, "Loop delay", font);
 	b->setTextColor(1, 0, 0);
 	b->addActionListener([&](gui::Component&) {
@@ -54,7 +61,7 @@ void testBorderLayout() {
 	group.add(panel->addDefault(std::make_shared<gui::Button>()));
 	group.add(panel->addDefault(std::make_shared<gui::Button>()));
 
-	auto comboBox = panel->addDefault<gui::ComboBox>(font, mw::Sprite("triangle.png"));
+	auto comboBox = panel->addDefault<gui::ComboBox>(font, atlas.getSprite("triangle.png"));
 	group.add(comboBox);
 	comboBox->addItem("Option 1");
 	comboBox->addItem("Option 2");
@@ -100,18 +107,31 @@ void testFlowLayout() {
 
 	frame.setDefaultClosing(true);
 	mw::Font font("Ubuntu-B.ttf", 16);
+	gui::SpriteAtlas atlas;
+	atlas.add("box.png");
+	atlas.add("check.png");
+	atlas.pack();
 	frame.setLayout(std::make_shared<gui::FlowLayout>(gui::FlowLayout::LEFT));
 	frame.addDefault<gui::Button>("Button 1", font);
 	frame.addDefault(std::make_shared<gui::Button>("Button 2", font));
 	auto button = frame.add<gui::Button>(gui::DEFAULT_INDEX, "Button 3", font);
 	button->setVerticalAlignment(gui::Button::TOP);
 	frame.add(gui::DEFAULT_INDEX, std::make_shared<gui::Button>("Button 4", font));
-	frame.add(gui::DEFAULT_INDEX, std::make_shared<gui::CheckBox>("CheckBox 5", font, mw::Sprite("box.png"), mw::Sprite("check.png")));
+	frame.add(gui::DEFAULT_INDEX, std::make_shared<gui::CheckBox>("CheckBox 5", font, atlas.getSprite("box.png"), atlas.getSprite("check.png")));
 	auto field = frame.addDefault<gui::TextField>("Text:", font);
 	field->setFocus(true);
 	frame.add(gui::DEFAULT_INDEX, std::make_shared<gui::TextField>("", font));
 	frame.add(gui::DEFAULT_INDEX, std::make_shared<gui::Label>("JAjajaj", font));
 
+	// Shown without sprites until the images are loaded.
+	auto checkBox = frame.addDefault<gui::CheckBox>("CheckBox 6", font, mw::Sprite(), mw::Sprite());
+	frame.getResourceLoader().loadSprite("box.png", [checkBox](const mw::Sprite& sprite) {
+		checkBox->setBoxSprite(sprite);
+	});
+	frame.getResourceLoader().loadSprite("check.png", [checkBox](const mw::Sprite& sprite) {
+		checkBox->setCheckSprite(sprite);
+	});
+
 	auto panel = std::make_shared<gui::Panel>();
 	panel->setBackgroundColor(0, 1, 0);
 	frame.add(gui::DEFAULT_INDEX, panel);
@@ -126,8 +146,108 @@ void testFlowLayout() {
 	frame.startLoop();
 }
 
+void testListView() {
+	gui::Frame frame;
+	frame.setOpenGlVersion(2, 1);
+	frame.setWindowSize(512, 512);
+	frame.setDefaultClosing(true);
+	mw::Font font("Ubuntu-B.ttf", 16);
+
+	auto listView = frame.add<gui::ListView>(gui::BorderLayout::CENTER, [&]() {
+		return std::make_shared<gui::Label>("", font);
+	}, [](gui::Component& row, int index) {
+		static_cast<gui::Label&>(row).setText("Row " + std::to_string(index));
+	}, 20.f);
+	listView->setRowCount(100000);
+	frame.setStatisticsOverlay(true);
+	frame.setStatisticsFont(font);
+
+	frame.startLoop();
+}
+
+namespace {
+
+	// Heap allocations not yet freed, counted by the global operator new and delete.
+	std::atomic<long> liveAllocations(0);
+
+	// Print the failed check. Not an assert, i.e. also checked in a release build.
+	bool check(bool condition, const char* what) {
+		if (!condition) {
+			std::cerr << "Check failed: " << what << "\n";
+		}
+		return condition;
+	}
+
+}
+
+void* operator new(std::size_t size) {
+	void* memory = std::malloc(size == 0 ? 1 : size);
+	if (memory == nullptr) {
+		throw std::bad_alloc();
+	}
+	++liveAllocations;
+	return memory;
+}
+
+void operator delete(void* memory) noexcept {
+	if (memory != nullptr) {
+		--liveAllocations;
+		std::free(memory);
+	}
+}
+
+// Add and remove subtrees, the memory must return to the level before. Both
+// the frame's arena and the heap, e.g. components created by std::make_shared,
+// layout managers and the panels' vectors. Return false if a check fails.
+bool testAddRemoveMemory() {
+	gui::Frame frame;
+	auto arena = frame.getArena();
+	bool passed = true;
+
+	std::weak_ptr<gui::Panel> lastPanel;
+	std::weak_ptr<gui::Component> lastChild;
+	std::weak_ptr<gui::Component> lastHeapChild;
+	auto addRemove = [&]() {
+		auto panel = frame.add<gui::Panel>(gui::DEFAULT_INDEX);
+		panel->setLayout<gui::FlowLayout>();
+		auto child = panel->add(gui::DEFAULT_INDEX, frame.create<gui::Panel>());
+		// Not allocated by the arena.
+		auto heapChild = std::make_shared<gui::Panel>();
+		heapChild->setLayout<gui::VerticalLayout>();
+		panel->add(gui::DEFAULT_INDEX, heapChild);
+		passed &= check(child->getParent() == panel, "child->getParent() == panel");
+		passed &= check(child->getAncestor() == frame.getCurrentPanel(), "child->getAncestor() == frame.getCurrentPanel()");
+		lastPanel = panel;
+		lastChild = child;
+		lastHeapChild = heapChild;
+		frame.getCurrentPanel()->remove(panel);
+		passed &= check(panel->getParent() == nullptr, "panel->getParent() == nullptr");
+	};
+
+	// The first round may grow memory kept for reuse, e.g. vector capacities.
+	addRemove();
+	size_t baseline = arena->getUsedBytes();
+	long heapBaseline = liveAllocations;
+	for (int i = 0; i < 10000; ++i) {
+		addRemove();
+	}
+
+	passed &= check(lastPanel.expired(), "lastPanel.expired()");
+	passed &= check(lastChild.expired(), "lastChild.expired()");
+	passed &= check(lastHeapChild.expired(), "lastHeapChild.expired()");
+	passed &= check(arena->getUsedBytes() == baseline, "arena->getUsedBytes() == baseline");
+	passed &= check(liveAllocations == heapBaseline, "liveAllocations == heapBaseline");
+	std::cout << "testAddRemoveMemory: " << arena->getUsedBytes() << " bytes used, "
+		<< baseline << " bytes before, " << liveAllocations - heapBaseline << " heap allocations left\n";
+	return passed;
+}
+
 int main(int argc, char** argv) {
+	if (!testAddRemoveMemory()) {
+		return 1;
+	}
 	testBorderLayout();
 	testFlowLayout();
+	testListView();
 	return 0;
 }